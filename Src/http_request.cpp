@@ -2,7 +2,20 @@
 #include <iostream>
 #include <sstream>
 #include <mutex>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#ifdef _WIN32
 #pragma comment(lib, "ws2_32.lib")
+#else
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 
 using namespace http_request;
 using namespace std;
@@ -24,17 +37,31 @@ string ReadLine(const char* buffer, size_t& length)
 	return string(buffer, len);
 }
 
-std::future<HTTPRespond> http_request::make_request(const string& url, ThreadPool* pool)
+std::future<HTTPRespond> http_request::make_request(const string& url, ThreadPool* pool, ConnectionPool* connections)
 {
-	const auto request_func = [](string host, string uri) {
-		std::unique_ptr<char, std::function<void(char*)>> result = move(Fetch(host, uri));
-		return ParseHTTP(result.get());
+	const auto request_func = [connections](string host, string uri) {
+		string content;
+		HTTPRespond respond = FetchStream(host, uri, [&content](const char* data, size_t size) { content.append(data, size); }, nullptr, connections);
+		respond.content = move(content);
+		return respond;
 	};
 	
+	string host, uri;
+	SplitURL(url, host, uri);
+
+	if (pool == nullptr)
+	{
+		return async(request_func, host, uri);
+	}
+
+	return pool->EnqueueTask(request_func, host, uri);
+}
+
+void http_request::SplitURL(const string& url, string& host, string& uri)
+{
 	if (url.empty())
 		throw invalid_argument("URL이 빈 문자열입니다");
 
-	string host, uri;
 	size_t ofs = url.find("://");
 	if (ofs != string::npos)
 	{
@@ -64,26 +91,26 @@ std::future<HTTPRespond> http_request::make_request(const string& url, ThreadPoo
 			uri = url.substr(endHost);
 		}
 	}
-
-	if (pool == nullptr)
-	{
-		return async(request_func, host, uri);
-	}
-
-	return pool->EnqueueTask(request_func, host, uri);
 }
 
-std::unique_ptr<char, std::function<void(char*)>> http_request::Fetch(const string& host, const string& uri)
+//keepAlive가 아니면 서버가 응답 후 바로 닫도록 요청
+static std::unordered_map<std::string, std::string> DefaultHeader(const string& host, bool keepAlive)
 {
-	auto s = MakeConnection(host);
-	std::unordered_map<std::string, std::string> additionalHeader;
-	additionalHeader = {
+	return {
+		{"Connection", keepAlive ? "keep-alive" : "close"},
 		{"User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/83.0.4103.106 Safari/537.36"},
 		{"Accept", "text/html,application/xhtml+xml,application/xml;\ q=0.9,imgwebp,*/*;q=0.8"},
 		{"Host", host}
 	};
-	SendRequest(s, uri, additionalHeader);
+}
+
+std::unique_ptr<char, std::function<void(char*)>> http_request::Fetch(const string& host, const string& uri)
+{
+	auto s = MakeConnection(host);
+	const unique_ptr<SOCKET, void(*)(SOCKET*)> closer(&s, [](SOCKET* ps) { closesocket(*ps); });
+	SendRequest(s, uri, DefaultHeader(host, false));
 
+	//서버가 응답 후 연결을 닫으므로 끊길 때까지 읽음
 	int rb;
 	char temp[512];
 	ostringstream oss;
@@ -91,7 +118,7 @@ std::unique_ptr<char, std::function<void(char*)>> http_request::Fetch(const stri
 		rb = recv(s, temp, 512, 0);
 		if (rb > 0)
 			oss.write(temp, rb);
-	} while (rb == 512);
+	} while (rb > 0);
 
 	if (rb == -1) {
 		string msg("�������� ���߽��ϴ� #");
@@ -111,6 +138,275 @@ std::unique_ptr<char, std::function<void(char*)>> http_request::Fetch(const stri
 	return buffer;
 }
 
+//chunked 본문의 틀(크기 줄, 줄바꿈, 트레일러)을 벗겨 데이터만 넘김. 조각이 어디서 잘려도 다음 Feed에서 이어서 읽음
+class ChunkedBody {
+	enum class State { SIZE, DATA, DATA_END, TRAILER, DONE };
+	State state = State::SIZE;
+	string line; //크기 줄이나 트레일러 줄이 조각에 걸쳐 있을 때 모아 두는 버퍼
+	size_t remain = 0; //현재 chunk에서 남은 데이터
+
+public:
+	bool Done() const noexcept { return state == State::DONE; }
+
+	//읽은 바이트 수를 반환. 본문이 끝나면 그 뒤의 데이터는 읽지 않음
+	size_t Feed(const char* p, size_t n, const function<void(const char*, size_t)>& on_body)
+	{
+		const char* const first = p;
+		const char* const last = p + n;
+		while (p != last && state != State::DONE)
+		{
+			if (state == State::DATA)
+			{
+				const size_t take = min<size_t>(remain, last - p);
+				on_body(p, take);
+				p += take;
+				remain -= take;
+				if (remain == 0)
+					state = State::DATA_END;
+				continue;
+			}
+
+			auto lf = static_cast<const char*>(memchr(p, '\n', last - p));
+			if (lf == NULL)
+			{
+				line.append(p, last);
+				if (line.size() > 4096)
+					throw runtime_error("chunk 줄이 너무 깁니다");
+				return n;
+			}
+			line.append(p, lf);
+			p = lf + 1;
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+
+			switch (state)
+			{
+			case State::SIZE: {
+				char* end;
+				remain = strtoull(line.c_str(), &end, 16); //';' 뒤의 확장은 무시
+				if (end == line.c_str())
+					throw runtime_error("chunk 크기를 읽을 수 없습니다");
+				state = remain == 0 ? State::TRAILER : State::DATA;
+				break;
+			}
+			case State::DATA_END:
+				if (!line.empty())
+					throw runtime_error("chunk 뒤에 줄바꿈이 없습니다");
+				state = State::SIZE;
+				break;
+			case State::TRAILER:
+				if (line.empty())
+					state = State::DONE;
+				break;
+			default:
+				break;
+			}
+			line.clear();
+		}
+		return p - first;
+	}
+};
+
+//헤더 이름은 대소문자를 구분하지 않음
+static const string* FindHeader(const HTTPRespond& respond, const char* name)
+{
+	const size_t len = strlen(name);
+	for (auto& pair : respond.header)
+	{
+		if (pair.first.size() == len && equal(pair.first.begin(), pair.first.end(), name, [](char a, char b) { return tolower(static_cast<unsigned char>(a)) == tolower(static_cast<unsigned char>(b)); }))
+			return &pair.second;
+	}
+	return nullptr;
+}
+
+//서버가 연결을 유지하겠다고 했는지. HTTP/1.1은 기본이 유지, HTTP/1.0은 기본이 닫기
+static bool KeepAlive(const HTTPRespond& respond)
+{
+	const string* connection = FindHeader(respond, "Connection");
+	string value = connection == nullptr ? string() : *connection;
+	transform(value.begin(), value.end(), value.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+	if (respond.version == "HTTP/1.1")
+		return value.find("close") == string::npos;
+	return value.find("keep-alive") != string::npos;
+}
+
+//응답을 받은 조각 단위로 읽는 상태 기계. 헤더를 읽은 뒤 본문을 on_body로 넘김
+//블로킹 recv(ReadRespond)와 epoll 리액터가 같은 것을 씀
+class ResponseReader {
+	enum class State { HEAD, CHUNKED, LENGTH, UNTIL_CLOSE, DONE };
+	State state = State::HEAD;
+	HTTPRespond respond;
+	const function<void(const char*, size_t)>& on_body;
+	const function<void(const HTTPRespond&)>& on_head;
+	string head; //헤더가 끝날 때까지 모아 두는 버퍼
+	size_t scanned = 0; //head에서 "\r\n\r\n"을 찾아 본 위치
+	ChunkedBody chunked;
+	size_t remain = 0; //Content-Length에서 남은 본문
+	bool started = false, keepAlive = false, extra = false;
+
+	void StartBody(const char* p, size_t n)
+	{
+		respond = ParseHTTP(head.c_str());
+		if (on_head)
+			on_head(respond);
+		keepAlive = KeepAlive(respond);
+
+		const string* encoding = FindHeader(respond, "Transfer-Encoding");
+		const string* length = FindHeader(respond, "Content-Length");
+		if (respond.code == 204 || respond.code == 304)
+		{
+			state = State::DONE;
+		}
+		else if (encoding != nullptr && encoding->find("chunked") != string::npos)
+		{
+			state = State::CHUNKED;
+		}
+		else if (length != nullptr)
+		{
+			remain = stoull(*length);
+			state = remain == 0 ? State::DONE : State::LENGTH;
+		}
+		else //길이를 알 수 없으면 연결이 끊길 때까지
+		{
+			state = State::UNTIL_CLOSE;
+		}
+		Feed(p, n);
+	}
+
+public:
+	ResponseReader(const function<void(const char*, size_t)>& on_body, const function<void(const HTTPRespond&)>& on_head)
+		: on_body(on_body), on_head(on_head) {}
+
+	void Feed(const char* p, size_t n)
+	{
+		if (n == 0)
+			return;
+		started = true;
+
+		switch (state)
+		{
+		case State::HEAD: {
+			head.append(p, n);
+			const size_t endHead = head.find("\r\n\r\n", scanned);
+			if (endHead == string::npos)
+			{
+				scanned = head.size() < 3 ? 0 : head.size() - 3; //끝이 다음 조각에 걸칠 수 있음
+				break;
+			}
+			const string rest = head.substr(endHead + 4); //헤더와 같이 받은 본문 앞부분
+			head.resize(endHead + 4);
+			StartBody(rest.data(), rest.size());
+			break;
+		}
+		case State::CHUNKED: {
+			const size_t used = chunked.Feed(p, n, on_body);
+			if (chunked.Done())
+			{
+				state = State::DONE;
+				extra = used != n;
+			}
+			break;
+		}
+		case State::LENGTH: {
+			const size_t take = min(remain, n);
+			on_body(p, take);
+			remain -= take;
+			if (remain == 0)
+			{
+				state = State::DONE;
+				extra = take != n;
+			}
+			break;
+		}
+		case State::UNTIL_CLOSE:
+			on_body(p, n);
+			break;
+		case State::DONE:
+			extra = true;
+			break;
+		}
+	}
+
+	//연결이 끊김. 연결 종료로 끝을 알리는 응답이 아니면 예외
+	void Close()
+	{
+		if (state == State::UNTIL_CLOSE)
+			state = State::DONE;
+		else if (state == State::HEAD)
+			throw runtime_error("헤더를 다 받기 전에 연결이 끊어졌습니다");
+		else if (state != State::DONE)
+			throw runtime_error("본문을 다 받기 전에 연결이 끊어졌습니다");
+	}
+
+	bool Done() const noexcept { return state == State::DONE; }
+	//응답의 첫 바이트를 받았는지 (쉬던 연결이 끊겨 있었는지 구분용)
+	bool Started() const noexcept { return started; }
+	//본문 끝을 정확히 알았고 남은 데이터가 없으며 서버가 연결을 유지하면 true
+	bool Reusable() const noexcept { return state == State::DONE && keepAlive && !extra; }
+	HTTPRespond& Respond() noexcept { return respond; }
+};
+
+//응답 하나를 읽어 본문을 on_body로 넘김. 연결을 다시 쓸 수 있으면 true
+//started는 응답의 첫 바이트를 받았는지 (쉬던 연결이 끊겨 있었는지 구분용)
+static bool ReadRespond(SOCKET s, const function<void(const char*, size_t)>& on_body, const function<void(const HTTPRespond&)>& on_head,
+	HTTPRespond& respond, bool& started)
+{
+	ResponseReader reader(on_body, on_head);
+	char temp[16384];
+	while (!reader.Done())
+	{
+		const int rb = recv(s, temp, static_cast<int>(sizeof(temp)), 0);
+		if (rb == SOCKET_ERROR)
+		{
+			string msg("수신하지 못했습니다 #");
+			msg += std::to_string(WSAGetLastError());
+			throw runtime_error(msg);
+		}
+		started = started || rb > 0;
+		if (rb == 0)
+		{
+			reader.Close();
+			break;
+		}
+		reader.Feed(temp, rb);
+	}
+	respond = move(reader.Respond());
+	return reader.Reusable();
+}
+
+HTTPRespond http_request::FetchStream(const string& host, const string& uri, const function<void(const char*, size_t)>& on_body,
+	const function<void(const HTTPRespond&)>& on_head, ConnectionPool* connections)
+{
+	HTTPRespond respond;
+	bool started = false;
+	if (connections == nullptr)
+	{
+		SOCKET s = MakeConnection(host);
+		const unique_ptr<SOCKET, void(*)(SOCKET*)> closer(&s, [](SOCKET* ps) { closesocket(*ps); });
+		SendRequest(s, uri, DefaultHeader(host, false));
+		ReadRespond(s, on_body, on_head, respond, started);
+		return respond;
+	}
+
+	while (true)
+	{
+		bool reused;
+		SOCKET s = connections->Acquire(host, reused);
+		started = false;
+		try {
+			SendRequest(s, uri, DefaultHeader(host, true));
+			const bool reusable = ReadRespond(s, on_body, on_head, respond, started);
+			connections->Release(host, s, reusable);
+			return respond;
+		}
+		catch (...) {
+			connections->Release(host, s, false);
+			if (!reused || started) //쉬던 연결이 응답 전에 끊긴 경우만 다시 보냄 (GET이므로 안전)
+				throw;
+		}
+	}
+}
+
 HTTPRespond http_request::ParseHTTP(const char* buffer)
 {
 	HTTPRespond respond;
@@ -126,7 +422,7 @@ HTTPRespond http_request::ParseHTTP(const char* buffer)
 	buffer += n + 2;
 	
 	{
-		auto idx = line.find_first_of(' '), bg = 0U;
+		size_t idx = line.find_first_of(' '), bg = 0;
 		if (idx == string::npos)
 			throw out_of_range("�̿ϼ� ����Դϴ�");
 		respond.version = line.substr(0, idx);
@@ -162,11 +458,11 @@ HTTPRespond http_request::ParseHTTP(const char* buffer)
 
 string http_request::ltrim(string o)
 {
-	o.erase(o.begin(), find_if_not(o.begin(), o.end(), ptr_fun<int, int>(std::isspace)));
+	o.erase(o.begin(), find_if_not(o.begin(), o.end(), [](unsigned char c) { return std::isspace(c) != 0; }));
 	return o;
 }
 
-SOCKET http_request::MakeConnection(string host)
+sockaddr_in http_request::ResolveAddress(string host)
 {
 	USHORT port = 80;
 	auto pidx = host.find_last_of(':');
@@ -193,31 +489,65 @@ SOCKET http_request::MakeConnection(string host)
 
 	ULONG ipAddress = results[0];
 	sockaddr_in address;
-	memset(&address, 0, sizeof sockaddr_in);
+	memset(&address, 0, sizeof(sockaddr_in));
 	address.sin_family = AF_INET;
 	address.sin_port = htons(port);
 	address.sin_addr.s_addr = ipAddress;
 
+	return address;
+}
+
+SOCKET http_request::MakeConnection(string host)
+{
+	sockaddr_in address = ResolveAddress(move(host));
+
 	SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 	if (s == INVALID_SOCKET)
 		throw runtime_error("������ �������� ���߽��ϴ�");
 
-	if (connect(s, reinterpret_cast<sockaddr*>(&address), sizeof sockaddr_in) == SOCKET_ERROR)
+	if (connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(sockaddr_in)) == SOCKET_ERROR)
 	{
+		const auto err = WSAGetLastError();
+		closesocket(s);
 		string msg = "���� ���� #";
-		msg += std::to_string(WSAGetLastError());
+		msg += std::to_string(err);
 		throw runtime_error(msg);
 	}
 
+	//keep-alive 연결에서 요청이 Nagle + 지연 ACK로 붙잡히지 않도록 바로 보냄
+	const int noDelay = 1;
+	setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
 	return s;
 }
 
 vector<ULONG> http_request::DNSLookup(const string& host)
 {
 	if (host == "localhost")
-		return vector<ULONG>({ INADDR_LOOPBACK });
+		return vector<ULONG>({ htonl(INADDR_LOOPBACK) }); //s_addr는 네트워크 바이트 순서
 
 	vector<ULONG> addresses;
+#ifndef _WIN32
+	//gethostbyname은 스레드에 안전하지 않으므로 getaddrinfo를 씀
+	addrinfo hints = {};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* list = nullptr;
+	int err = getaddrinfo(host.c_str(), NULL, &hints, &list);
+	for (int retry = 0; err == EAI_AGAIN && retry < 3; retry++)
+		err = getaddrinfo(host.c_str(), NULL, &hints, &list);
+	if (err != 0)
+	{
+		string msg = "주소를 찾을 수 없습니다 #";
+		msg += gai_strerror(err);
+		throw runtime_error(msg);
+	}
+
+	for (auto p = list; p != NULL; p = p->ai_next)
+		addresses.push_back(reinterpret_cast<sockaddr_in*>(p->ai_addr)->sin_addr.s_addr);
+	freeaddrinfo(list);
+	return addresses;
+#else
 	auto result = gethostbyname(host.c_str());
 	if (result == NULL)
 	{
@@ -245,9 +575,10 @@ ENDERROR:
 		result->h_addr_list++;
 	}
 	return addresses;
+#endif
 }
 
-size_t http_request::SendRequest(SOCKET ss, const std::string& uri, const std::unordered_map<std::string, std::string>& header)
+string http_request::BuildRequest(const std::string& uri, const std::unordered_map<std::string, std::string>& header)
 {
 	ostringstream context;
 	context << "GET " << uri << " HTTP/1.1" << "\r\n";
@@ -256,20 +587,25 @@ size_t http_request::SendRequest(SOCKET ss, const std::string& uri, const std::u
 		context << pair.first << ": " << pair.second << "\r\n";
 	}
 	context << "\r\n";
-	string full = context.str();
+	return context.str();
+}
+
+size_t http_request::SendRequest(SOCKET ss, const std::string& uri, const std::unordered_map<std::string, std::string>& header)
+{
+	string full = BuildRequest(uri, header);
 	auto const raw = full.c_str();
 	const size_t len = full.size();
 	size_t sentbytes = 0;
 	const size_t dataUnit = 512;
 
 	do {
-		size_t t = 0;
+		int t = 0; //한 번에 dataUnit 이하만 보내므로 int로 충분 (WinSock은 int, POSIX는 ssize_t를 반환)
 		if (len - sentbytes > dataUnit)
-			t = send(ss, raw + sentbytes, dataUnit, 0);
+			t = static_cast<int>(send(ss, raw + sentbytes, static_cast<int>(dataUnit), SEND_FLAGS));
 		else
-			t = send(ss, raw + sentbytes, len - sentbytes, 0);
+			t = static_cast<int>(send(ss, raw + sentbytes, static_cast<int>(len - sentbytes), SEND_FLAGS));
 
-		if (t == -1)
+		if (t == SOCKET_ERROR)
 		{
 			string msg("���� ���� #");
 			msg += std::to_string(WSAGetLastError());
@@ -280,3 +616,498 @@ size_t http_request::SendRequest(SOCKET ss, const std::string& uri, const std::u
 
 	return sentbytes;
 }
+
+
+//쉬는 동안 서버가 닫았거나(읽을 수 있음 = FIN) 예상하지 않은 데이터가 온 연결은 다시 쓸 수 없음
+static bool IsIdleAlive(SOCKET s)
+{
+#ifdef _WIN32
+	fd_set readable;
+	FD_ZERO(&readable);
+	FD_SET(s, &readable);
+	timeval zero = { 0, 0 };
+	return select(static_cast<int>(s + 1), &readable, NULL, NULL, &zero) == 0;
+#else
+	pollfd p = { s, POLLIN, 0 }; //select는 FD_SETSIZE를 넘는 fd를 다룰 수 없음
+	return poll(&p, 1, 0) == 0;
+#endif
+}
+
+ConnectionPool::ConnectionPool(size_t maxIdle, std::chrono::milliseconds idleTimeout) : maxIdle(maxIdle), idleTimeout(idleTimeout)
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+	Clear();
+}
+
+SOCKET ConnectionPool::Acquire(const string& host, bool& reused)
+{
+	const auto now = chrono::steady_clock::now();
+	while (true)
+	{
+		Idle found;
+		{
+			lock_guard<mutex> lk(lock);
+			auto it = idle.find(host);
+			if (it == idle.end() || it->second.empty())
+				break;
+			found = it->second.back(); //가장 최근에 쓴 연결이 살아 있을 가능성이 큼
+			it->second.pop_back();
+		}
+
+		if (now - found.since < idleTimeout && IsIdleAlive(found.s))
+		{
+			reused = true;
+			return found.s;
+		}
+		closesocket(found.s);
+	}
+
+	reused = false;
+	return MakeConnection(host);
+}
+
+void ConnectionPool::Release(const string& host, SOCKET s, bool reusable)
+{
+	if (reusable)
+	{
+		lock_guard<mutex> lk(lock);
+		auto& list = idle[host];
+		if (list.size() < maxIdle)
+		{
+			list.push_back(Idle{ s, chrono::steady_clock::now() });
+			return;
+		}
+	}
+	closesocket(s);
+}
+
+size_t ConnectionPool::IdleCount()
+{
+	lock_guard<mutex> lk(lock);
+	size_t count = 0;
+	for (auto& pair : idle)
+		count += pair.second.size();
+	return count;
+}
+
+void ConnectionPool::Clear()
+{
+	lock_guard<mutex> lk(lock);
+	for (auto& pair : idle)
+	{
+		for (auto& i : pair.second)
+			closesocket(i.s);
+	}
+	idle.clear();
+}
+
+#ifdef __linux__
+static runtime_error SocketError(const char* what, int err)
+{
+	string msg(what);
+	msg += std::to_string(err);
+	return runtime_error(msg);
+}
+
+//리액터가 처리하는 요청 하나. reader가 on_body, on_head를 참조하므로 만든 뒤에는 옮기지 않음
+struct ReactorRequest {
+	string host, uri;
+	sockaddr_in address;
+	string request; //보낼 요청 전체
+	size_t sent = 0;
+	string content;
+	function<void(const char*, size_t)> on_body;
+	function<void(const HTTPRespond&)> on_head;
+	unique_ptr<ResponseReader> reader;
+	promise<HTTPRespond> result;
+	bool reused = false; //쉬던 연결을 꺼냈는지
+	bool connecting = false;
+	uint64_t id = 0; //타이머가 같은 fd 번호를 다시 쓴 다른 요청을 건드리지 않도록 구분
+};
+
+struct Reactor::Loop {
+	using Clock = chrono::steady_clock;
+
+	//요청 마감 시각이나 쉬는 연결의 만료 시각. fd와 id가 지금 것과 다르면 이미 끝난 것이므로 무시
+	struct Timer {
+		Clock::time_point when;
+		int fd;
+		uint64_t id;
+		bool operator>(const Timer& o) const { return when > o.when; }
+	};
+
+	struct IdleConn {
+		string host;
+		uint64_t id;
+	};
+
+	int epfd = -1, wake = -1;
+	size_t maxIdle;
+	chrono::milliseconds timeout, idleTimeout;
+	thread worker;
+
+	mutex lock; //incoming, stop 보호
+	vector<unique_ptr<ReactorRequest>> incoming;
+	bool stop = false;
+
+	//아래는 worker만 씀
+	unordered_map<int, unique_ptr<ReactorRequest>> active;
+	unordered_map<string, vector<int>> idle;
+	unordered_map<int, IdleConn> idleHost;
+	vector<unique_ptr<ReactorRequest>> retry;
+	priority_queue<Timer, vector<Timer>, greater<Timer>> timers;
+	uint64_t lastId = 0;
+	char buffer[65536];
+
+	Loop(size_t maxIdle, chrono::milliseconds timeout, chrono::milliseconds idleTimeout)
+		: maxIdle(maxIdle), timeout(timeout), idleTimeout(idleTimeout)
+	{
+		epfd = epoll_create1(EPOLL_CLOEXEC);
+		wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (epfd < 0 || wake < 0)
+			throw SocketError("epoll을 만들지 못했습니다 #", errno);
+		if (!Watch(wake, EPOLLIN, EPOLL_CTL_ADD))
+			throw SocketError("epoll에 등록하지 못했습니다 #", errno);
+		worker = thread([this]() { this->Run(); });
+	}
+
+	~Loop()
+	{
+		{
+			lock_guard<mutex> lk(lock);
+			stop = true;
+		}
+		Wake();
+		worker.join();
+		close(wake);
+		close(epfd);
+	}
+
+	void Wake()
+	{
+		const uint64_t one = 1;
+		(void)!write(wake, &one, sizeof(one));
+	}
+
+	//실패하면 errno가 남음. 등록되지 않은 fd에는 이벤트가 오지 않으므로 호출자가 바로 실패시켜야 함
+	bool Watch(int fd, uint32_t events, int op)
+	{
+		epoll_event ev = {};
+		ev.events = events;
+		ev.data.fd = fd;
+		return epoll_ctl(epfd, op, fd, &ev) == 0;
+	}
+
+	void Post(unique_ptr<ReactorRequest> req)
+	{
+		{
+			lock_guard<mutex> lk(lock);
+			if (!stop)
+			{
+				incoming.push_back(move(req));
+				req = nullptr;
+			}
+		}
+		if (req != nullptr)
+			req->result.set_exception(make_exception_ptr(runtime_error("리액터가 멈췄습니다")));
+		else
+			Wake();
+	}
+
+	//쉬는 연결이 있으면 그것으로, 없으면 논블로킹 connect로 시작
+	void Start(unique_ptr<ReactorRequest> req)
+	{
+		req->reader = make_unique<ResponseReader>(req->on_body, req->on_head);
+		req->sent = 0;
+		req->content.clear();
+
+		int fd;
+		bool watched;
+		auto it = idle.find(req->host);
+		if (it != idle.end() && !it->second.empty())
+		{
+			fd = it->second.back();
+			it->second.pop_back();
+			idleHost.erase(fd);
+			req->reused = true;
+			req->connecting = false;
+			watched = Watch(fd, EPOLLOUT, EPOLL_CTL_MOD);
+		}
+		else
+		{
+			req->reused = false;
+			fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+			if (fd < 0)
+				return req->result.set_exception(make_exception_ptr(SocketError("소켓을 만들지 못했습니다 #", errno)));
+			const int noDelay = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+			if (connect(fd, reinterpret_cast<const sockaddr*>(&req->address), sizeof(sockaddr_in)) != 0 && errno != EINPROGRESS)
+			{
+				const int err = errno;
+				close(fd);
+				return req->result.set_exception(make_exception_ptr(SocketError("연결 실패 #", err)));
+			}
+			req->connecting = true;
+			watched = Watch(fd, EPOLLOUT, EPOLL_CTL_ADD);
+		}
+		const int err = errno;
+		req->id = ++lastId;
+		timers.push({ Clock::now() + timeout, fd, req->id });
+		active[fd] = move(req);
+		if (!watched)
+			Fail(fd, make_exception_ptr(SocketError("epoll에 등록하지 못했습니다 #", err)));
+	}
+
+	void Handle(int fd)
+	{
+		ReactorRequest& req = *active[fd];
+		try {
+			if (req.sent < req.request.size())
+			{
+				if (req.connecting)
+				{
+					int err = 0;
+					socklen_t len = sizeof(err);
+					getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+					if (err != 0)
+						throw SocketError("연결 실패 #", err);
+					req.connecting = false;
+				}
+				while (req.sent < req.request.size())
+				{
+					const ssize_t n = send(fd, req.request.data() + req.sent, req.request.size() - req.sent, MSG_NOSIGNAL);
+					if (n < 0)
+					{
+						if (errno == EAGAIN || errno == EWOULDBLOCK)
+							return;
+						if (errno == EINTR)
+							continue;
+						throw SocketError("전송 실패 #", errno);
+					}
+					req.sent += n;
+				}
+				if (!Watch(fd, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_MOD))
+					throw SocketError("epoll에 등록하지 못했습니다 #", errno);
+				return;
+			}
+
+			while (!req.reader->Done())
+			{
+				const ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+				if (n < 0)
+				{
+					if (errno == EAGAIN || errno == EWOULDBLOCK)
+						return;
+					if (errno == EINTR)
+						continue;
+					throw SocketError("수신하지 못했습니다 #", errno);
+				}
+				if (n == 0)
+				{
+					req.reader->Close();
+					break;
+				}
+				req.reader->Feed(buffer, n);
+			}
+			Finish(fd);
+		}
+		catch (...) {
+			Fail(fd, current_exception());
+		}
+	}
+
+	void Finish(int fd)
+	{
+		unique_ptr<ReactorRequest> req = move(active.extract(fd).mapped());
+		const bool reusable = req->reader->Reusable();
+		HTTPRespond respond = move(req->reader->Respond());
+		respond.content = move(req->content);
+		req->result.set_value(move(respond));
+
+		auto& list = idle[req->host];
+		if (reusable && list.size() < maxIdle)
+		{
+			list.push_back(fd); //EPOLLIN | EPOLLRDHUP을 그대로 지켜봄
+			idleHost.emplace(fd, IdleConn{ req->host, ++lastId });
+			timers.push({ Clock::now() + idleTimeout, fd, lastId });
+		}
+		else
+		{
+			close(fd);
+		}
+	}
+
+	void Fail(int fd, exception_ptr error)
+	{
+		unique_ptr<ReactorRequest> req = move(active.extract(fd).mapped());
+		close(fd);
+		if (req->reused && !req->reader->Started()) //쉬던 연결이 응답 전에 끊긴 경우만 다시 보냄 (GET이므로 안전)
+			retry.push_back(move(req));
+		else
+			req->result.set_exception(error);
+	}
+
+	//쉬는 연결에 이벤트가 오면 서버가 닫았거나 예상하지 않은 데이터가 온 것
+	void DropIdle(int fd)
+	{
+		auto it = idleHost.find(fd);
+		auto& list = idle[it->second.host];
+		list.erase(find(list.begin(), list.end(), fd));
+		idleHost.erase(it);
+		close(fd);
+	}
+
+	//마감이 지난 요청은 실패시키고 만료된 쉬는 연결은 닫음
+	void Expire()
+	{
+		const auto now = Clock::now();
+		while (!timers.empty() && timers.top().when <= now)
+		{
+			const Timer t = timers.top();
+			timers.pop();
+
+			auto req = active.find(t.fd);
+			if (req != active.end() && req->second->id == t.id)
+			{
+				const char* what = req->second->connecting ? "연결 시간 초과" : "응답 시간 초과";
+				unique_ptr<ReactorRequest> expired = move(active.extract(req).mapped());
+				close(t.fd);
+				expired->result.set_exception(make_exception_ptr(runtime_error(what)));
+				continue;
+			}
+			auto conn = idleHost.find(t.fd);
+			if (conn != idleHost.end() && conn->second.id == t.id)
+				DropIdle(t.fd);
+		}
+	}
+
+	//가장 가까운 타이머까지 남은 시간(ms). 타이머가 없으면 -1
+	int WaitTime() const
+	{
+		if (timers.empty())
+			return -1;
+		const auto left = chrono::ceil<chrono::milliseconds>(timers.top().when - Clock::now()).count();
+		return static_cast<int>(std::clamp<long long>(left, 0, INT_MAX));
+	}
+
+	void Run()
+	{
+		epoll_event events[256];
+		while (true)
+		{
+			const int n = epoll_wait(epfd, events, 256, WaitTime());
+			if (n < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				break;
+			}
+
+			bool woke = false;
+			for (int i = 0; i < n; i++)
+			{
+				const int fd = events[i].data.fd;
+				if (fd == wake)
+					woke = true;
+				else if (active.count(fd) != 0)
+					Handle(fd);
+				else if (idleHost.count(fd) != 0)
+					DropIdle(fd);
+			}
+			Expire();
+
+			//새 소켓은 묶음을 다 처리한 뒤에 만듦. 묶음 중에 닫은 fd 번호가 바로 재사용되면 남은 이벤트가 다른 요청에 갈 수 있음
+			vector<unique_ptr<ReactorRequest>> starting;
+			starting.swap(retry);
+			if (woke)
+			{
+				uint64_t count;
+				(void)!read(wake, &count, sizeof(count));
+				lock_guard<mutex> lk(lock);
+				if (stop)
+				{
+					retry.swap(starting); //아래에서 실패로 끝냄
+					break;
+				}
+				for (auto& req : incoming)
+					starting.push_back(move(req));
+				incoming.clear();
+			}
+			for (auto& req : starting)
+				Start(move(req));
+		}
+
+		const auto error = make_exception_ptr(runtime_error("리액터가 멈췄습니다"));
+		for (auto& pair : active)
+		{
+			close(pair.first);
+			pair.second->result.set_exception(error);
+		}
+		for (auto& req : retry)
+			req->result.set_exception(error);
+		for (auto& pair : idleHost)
+			close(pair.first);
+		lock_guard<mutex> lk(lock);
+		for (auto& req : incoming)
+			req->result.set_exception(error);
+	}
+};
+
+Reactor::Reactor(size_t threads, size_t maxIdle, chrono::milliseconds timeout, chrono::milliseconds idleTimeout)
+{
+	if (threads == 0)
+		throw invalid_argument("스레드 수는 0보다 커야합니다");
+	for (size_t i = 0; i < threads; i++)
+		loops.push_back(make_unique<Loop>(maxIdle, timeout, idleTimeout));
+}
+
+Reactor::~Reactor()
+{
+}
+
+future<HTTPRespond> Reactor::Submit(const string& host, const string& uri)
+{
+	auto req = make_unique<ReactorRequest>();
+	auto result = req->result.get_future();
+	req->host = host;
+	req->uri = uri;
+	req->request = BuildRequest(uri, DefaultHeader(host, true));
+	req->on_body = [r = req.get()](const char* data, size_t size) { r->content.append(data, size); };
+
+	try {
+		bool found = false;
+		{
+			lock_guard<mutex> lk(lock);
+			auto it = resolved.find(host);
+			if (it != resolved.end())
+			{
+				req->address = it->second;
+				found = true;
+			}
+		}
+		if (!found)
+		{
+			req->address = ResolveAddress(host);
+			lock_guard<mutex> lk(lock);
+			resolved.emplace(host, req->address);
+		}
+	}
+	catch (...) {
+		req->result.set_exception(current_exception());
+		return result;
+	}
+
+	loops[next++ % loops.size()]->Post(move(req));
+	return result;
+}
+
+future<HTTPRespond> http_request::make_request(const string& url, Reactor& reactor)
+{
+	string host, uri;
+	SplitURL(url, host, uri);
+	return reactor.Submit(host, uri);
+}
+#endif
@@ -1,6 +1,14 @@
 #pragma once
+#ifdef _WIN32
 #define _WINSOCK_DEPRECATED_NO_WARNINGS
 #include <WinSock2.h>
+#else
+#include <cerrno>
+#include <cstdint>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 #include <string>
 #include <functional>
 #include <unordered_map>
@@ -8,8 +16,28 @@
 #include <queue>
 #include <future>
 #include <iostream>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include "thread_pool.hpp"
 
 namespace http_request {
+#ifndef _WIN32
+	//POSIX 소켓을 WinSock과 같은 이름으로 씀
+	using SOCKET = int;
+	using ULONG = uint32_t;
+	using USHORT = unsigned short;
+	constexpr SOCKET INVALID_SOCKET = -1;
+	constexpr int SOCKET_ERROR = -1;
+	constexpr int SEND_FLAGS = MSG_NOSIGNAL; //끊긴 연결에 쓸 때 SIGPIPE 대신 오류를 받음
+
+	inline int closesocket(SOCKET s) { return ::close(s); }
+	inline int WSAGetLastError() { return errno; }
+#else
+	constexpr int SEND_FLAGS = 0;
+#endif
+
 	struct HTTPRespond {
 		int code=0;
 		std::string respondMessage, version, content;
@@ -17,84 +45,72 @@ namespace http_request {
 		bool headerOnly = false;
 	};
 
-	class ThreadPool {
-		std::vector<std::thread> threads;
-		std::queue<std::function<void()>> tasks;
-		std::mutex lock;
-		std::condition_variable cv;
-		bool stop;
+	//호스트별 keep-alive 연결 풀. 응답을 끝까지 읽었고 서버가 닫지 않겠다고 한 연결만 돌려받아 다음 요청에 다시 씀
+	//여러 ThreadPool 작업자가 함께 써도 됨. 쉬는 연결은 호스트마다 maxIdle개까지, idleTimeout 동안만 보관
+	class ConnectionPool {
+		struct Idle {
+			SOCKET s;
+			std::chrono::steady_clock::time_point since;
+		};
 
-		void Work()
-		{
-			while (true)
-			{
-				std::unique_lock<std::mutex> lk(lock);
-				cv.wait(lk, [this]() {return this->stop || !this->tasks.empty(); });
-				if (stop)
-					return;
-				std::function<void()> task = move(tasks.front());
-				tasks.pop();
-				lk.unlock();
-				
-				task();
-			}
-		}
+		std::unordered_map<std::string, std::vector<Idle>> idle;
+		std::mutex lock;
+		size_t maxIdle;
+		std::chrono::milliseconds idleTimeout;
 	public:
-		ThreadPool() = delete;
-		ThreadPool(const ThreadPool&) = delete;
-		ThreadPool(ThreadPool&&) = delete;
-		ThreadPool(size_t count) : stop(false)
-		{
-			if (count == 0)
-				throw std::invalid_argument("  0 Ŀմϴ");
-			for (int i = 0; i < count; i++)
-			{
-				threads.push_back(std::thread([this]() { this->Work(); }));
-			}
-		}
+		explicit ConnectionPool(size_t maxIdle = 8, std::chrono::milliseconds idleTimeout = std::chrono::seconds(30));
+		ConnectionPool(const ConnectionPool&) = delete;
+		~ConnectionPool();
 
-		void Stop()
-		{
-			stop = true;
-			cv.notify_all();
-		}
+		//살아 있는 쉬는 연결이 있으면 꺼내고 없으면 새로 연결. reused는 쉬는 연결을 꺼냈는지
+		SOCKET Acquire(const std::string& host, bool& reused);
+		//reusable이면 쉬는 연결로 보관하고, 아니면(또는 자리가 없으면) 닫음
+		void Release(const std::string& host, SOCKET s, bool reusable);
+		size_t IdleCount();
+		//쉬는 연결을 모두 닫음
+		void Clear();
+	};
 
-		~ThreadPool()
-		{
-			Stop();
+#ifdef __linux__
+	//epoll로 논블로킹 소켓 여러 개를 몇 개의 스레드에서 돌아가며 처리하는 요청 엔진. 요청마다 스레드가 recv/send에서 멈추지 않음
+	//스레드마다 epoll과 호스트별 keep-alive 연결을 따로 가지므로 스레드끼리 잠금이 없음. 쉬는 연결은 스레드당 호스트마다 maxIdle개까지
+	//호스트 주소는 처음 요청할 때 Submit을 부른 스레드에서 조회하고 이후에는 저장해 둔 것을 씀
+	//요청은 연결부터 응답 끝까지 timeout 안에 끝나야 하고, 쉬는 연결은 idleTimeout 동안만 보관
+	class Reactor {
+		struct Loop;
+		std::vector<std::unique_ptr<Loop>> loops;
+		std::atomic<size_t> next{ 0 };
+		std::unordered_map<std::string, sockaddr_in> resolved;
+		std::mutex lock;
+	public:
+		explicit Reactor(size_t threads = 1, size_t maxIdle = 8, std::chrono::milliseconds timeout = std::chrono::seconds(30),
+			std::chrono::milliseconds idleTimeout = std::chrono::seconds(30));
+		Reactor(const Reactor&) = delete;
+		~Reactor(); //끝나지 않은 요청은 예외로 끝남
 
-			for (size_t i = 0U; i < threads.size(); i++)
-			{
-				if (threads[i].joinable())
-					threads[i].join();
-			}
-		}
-		
-		template <typename Fn, typename... Args>
-		auto EnqueueTask(Fn&& fn, Args&&... args)
-		{
-			using namespace std;
-			using rType = typename result_of<Fn(Args...)>::type;
-			auto task = make_shared<packaged_task<rType()>>(
-				std::bind(forward<Fn>(fn), forward<Args>(args)...)
-				);
-			auto future = task->get_future();
-			{
-				lock_guard<mutex> lk(lock);
-				tasks.push([task]() { (*task)(); });
-			}
-			cv.notify_one();
-			return future;
-		}
+		std::future<HTTPRespond> Submit(const std::string& host, const std::string& uri);
 	};
 
-	std::future<HTTPRespond> make_request(const std::string& url, ThreadPool* pool=nullptr);
+	std::future<HTTPRespond> make_request(const std::string& url, Reactor& reactor);
+#endif
+
+	//connections가 있으면 그 풀의 연결을 다시 씀
+	std::future<HTTPRespond> make_request(const std::string& url, ThreadPool* pool=nullptr, ConnectionPool* connections=nullptr);
+	void SplitURL(const std::string& url, std::string& host, std::string& uri);
 	
 	HTTPRespond ParseHTTP(const char* buffer);
 	std::string ltrim(std::string o);
 
 	std::unique_ptr<char, std::function<void(char*)>> Fetch(const std::string& host, const std::string& uri);
+	//본문을 모으지 않고 받는 대로 on_body에 넘김 (Content-Length, chunked, 연결 종료까지 읽기 모두 지원)
+	//on_head는 헤더를 읽은 직후 본문보다 먼저 호출됨. 반환값의 content는 비어 있음
+	//connections가 있으면 그 풀의 연결을 쓰고, 쉬던 연결이 응답 전에 끊겨 있었으면 새 연결로 다시 보냄
+	HTTPRespond FetchStream(const std::string& host, const std::string& uri, const std::function<void(const char*, size_t)>& on_body,
+		const std::function<void(const HTTPRespond&)>& on_head = nullptr, ConnectionPool* connections = nullptr);
 	SOCKET MakeConnection(std::string host);
+	//"host[:port]"의 주소. 포트가 없으면 80
+	sockaddr_in ResolveAddress(std::string host);
 	std::vector<ULONG> DNSLookup(const std::string& host);
+	std::string BuildRequest(const std::string& uri, const std::unordered_map<std::string, std::string>& header);
 	size_t SendRequest(SOCKET ss, const std::string& uri, const std::unordered_map<std::string, std::string>& header);
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include <string.h>
 #include <sstream>
 #include <algorithm>
+#include <charconv>
+#include <cmath>
+#include "mapped_file.hpp"
 using namespace namespace_json_;
 using namespace std;
 
@@ -15,10 +18,66 @@ JSONValue::JSONValue(VALUE_TYPE type) noexcept : type(type)
 {
 }
 
+std::string JSONValue::Repr() const
+{
+	std::string rep;
+	AppendRepr(rep);
+	return rep;
+}
+
+//이스케이프가 필요 없는 구간은 한 번에 복사
+static void AppendEscaped(std::string& out, std::string_view s)
+{
+	static const char hex[] = "0123456789abcdef";
+	out.push_back('"');
+	size_t run = 0;
+	for (size_t i = 0; i < s.size(); i++) {
+		const unsigned char c = static_cast<unsigned char>(s[i]);
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
+
+		out.append(s.data() + run, i - run);
+		run = i + 1;
+		switch (c) {
+		case '"':
+			out.append("\\\"", 2);
+			break;
+		case '\\':
+			out.append("\\\\", 2);
+			break;
+		case '\b':
+			out.append("\\b", 2);
+			break;
+		case '\f':
+			out.append("\\f", 2);
+			break;
+		case '\n':
+			out.append("\\n", 2);
+			break;
+		case '\r':
+			out.append("\\r", 2);
+			break;
+		case '\t':
+			out.append("\\t", 2);
+			break;
+		default: {
+			const char u[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+			out.append(u, sizeof(u));
+		}
+		}
+	}
+	out.append(s.data() + run, s.size() - run);
+	out.push_back('"');
+}
+
 JSONString::JSONString(const char* str) : JSONValue(VALUE_TYPE::STRING), std::string(str)
 {
 }
 
+JSONString::JSONString(const char* str, size_t length) : JSONValue(VALUE_TYPE::STRING), std::string(str, length)
+{
+}
+
 JSONString::JSONString(const JSONString& o) : JSONValue(VALUE_TYPE::STRING), std::string(o)
 {
 }
@@ -32,9 +91,16 @@ void namespace_json_::JSONString::Put(const char* str)
 	*this = str;
 }
 
-std::string namespace_json_::JSONString::Repr() const
+void namespace_json_::JSONString::AppendRepr(std::string& out) const
 {
-	return std::string();
+	AppendEscaped(out, *this);
+}
+
+static std::string_view StringOf(const JSONValue* v)
+{
+	if (v->type == VALUE_TYPE::STRING_REF)
+		return *static_cast<const JSONStringRef*>(v);
+	return *static_cast<const JSONString*>(v);
 }
 
 bool namespace_json_::JSONString::Equal(JSONValue* o) const
@@ -42,11 +108,11 @@ bool namespace_json_::JSONString::Equal(JSONValue* o) const
 	if (o == this) {
 		return true;
 	}
-	else if (o->type != this->type) {
+	else if (o->type != VALUE_TYPE::STRING && o->type != VALUE_TYPE::STRING_REF) {
 		return false;
 	}
 
-	return *static_cast<JSONString*>(o) == *this; //std::string compare
+	return StringOf(o) == *this;
 }
 
 JSONValue* namespace_json_::JSONString::Clone() const
@@ -54,6 +120,36 @@ JSONValue* namespace_json_::JSONString::Clone() const
 	return new JSONString(*this);
 }
 
+JSONStringRef::JSONStringRef(std::string_view str) noexcept : JSONValue(VALUE_TYPE::STRING_REF), std::string_view(str)
+{
+}
+
+JSONStringRef::JSONStringRef(const JSONStringRef& o) noexcept : JSONValue(VALUE_TYPE::STRING_REF), std::string_view(o)
+{
+}
+
+void JSONStringRef::AppendRepr(std::string& out) const
+{
+	AppendEscaped(out, *this);
+}
+
+bool JSONStringRef::Equal(JSONValue* o) const
+{
+	if (o == this) {
+		return true;
+	}
+	else if (o->type != VALUE_TYPE::STRING && o->type != VALUE_TYPE::STRING_REF) {
+		return false;
+	}
+
+	return StringOf(o) == *this;
+}
+
+JSONValue* JSONStringRef::Clone() const
+{
+	return new JSONStringRef(*this);
+}
+
 JSONBoolean::JSONBoolean(const bool& v) noexcept : JSONValue(VALUE_TYPE::BOOLEAN), value{ v }
 {
 }
@@ -62,9 +158,9 @@ JSONBoolean::JSONBoolean(const JSONBoolean& o) noexcept : JSONValue(VALUE_TYPE::
 {
 }
 
-std::string namespace_json_::JSONBoolean::Repr() const
+void namespace_json_::JSONBoolean::AppendRepr(std::string& out) const
 {
-	return value ? "true" : "false";
+	out += value ? "true" : "false";
 }
 
 bool namespace_json_::JSONBoolean::Equal(JSONValue* o) const
@@ -88,9 +184,9 @@ namespace_json_::JSONNull::JSONNull() noexcept : JSONValue(VALUE_TYPE::JNULL)
 {
 }
 
-std::string namespace_json_::JSONNull::Repr() const
+void namespace_json_::JSONNull::AppendRepr(std::string& out) const
 {
-	return "null";
+	out += "null";
 }
 
 bool JSONNull::Equal(JSONValue* o) const
@@ -120,6 +216,12 @@ JSONNumber::JSONNumber(const int& v) noexcept : JSONValue(VALUE_TYPE::NUMBER)
 	iVal = v;
 }
 
+JSONNumber::JSONNumber(const int64_t& v) noexcept : JSONValue(VALUE_TYPE::NUMBER)
+{
+	isFloating = false;
+	iVal = v;
+}
+
 JSONNumber::JSONNumber(const JSONNumber& o) noexcept : JSONValue(VALUE_TYPE::NUMBER), isFloating{o.isFloating}
 {
 	if (isFloating) {
@@ -142,6 +244,12 @@ void JSONNumber::Put(const int& v) noexcept
 	iVal = v;
 }
 
+void JSONNumber::Put(const int64_t& v) noexcept
+{
+	isFloating = false;
+	iVal = v;
+}
+
 bool JSONNumber::IsFloating() const noexcept
 {
 	return isFloating;
@@ -155,15 +263,30 @@ double JSONNumber::GetAsFloat() const
 }
 
 int JSONNumber::GetAsInt() const
+{
+	return static_cast<int>(GetAsInt64());
+}
+
+int64_t JSONNumber::GetAsInt64() const
 {
 	if (isFloating)
-		return static_cast<int>(fVal);
+		return static_cast<int64_t>(fVal);
 	return iVal;
 }
 
-std::string namespace_json_::JSONNumber::Repr() const
+void namespace_json_::JSONNumber::AppendRepr(std::string& out) const
 {
-	return isFloating ? std::to_string(fVal) : std::to_string(iVal);
+	//to_chars는 로케일과 무관하며 실수는 다시 읽으면 같은 값이 되는 가장 짧은 표현을 씀
+	char buf[32];
+	if (!isFloating) {
+		out.append(buf, to_chars(buf, buf + sizeof(buf), iVal).ptr - buf);
+	}
+	else if (!isfinite(fVal)) { //JSON에는 무한대와 NaN이 없음
+		out += "null";
+	}
+	else {
+		out.append(buf, to_chars(buf, buf + sizeof(buf), fVal).ptr - buf);
+	}
 }
 
 bool namespace_json_::JSONNumber::Equal(JSONValue* o) const
@@ -192,11 +315,10 @@ JSONObject::JSONObject() : JSONValue(VALUE_TYPE::OBJECT)
 {
 }
 
-JSONObject::JSONObject(const JSONObject& o) : JSONValue(VALUE_TYPE::OBJECT)
+JSONObject::JSONObject(const JSONObject& o) : JSONValue(VALUE_TYPE::OBJECT), base_map()
 {
 	for (auto it : o) {
-		auto pair = make_pair(it.first, it.second->Clone());
-		insert(pair);
+		Put(it.first, it.second->Clone());
 	}
 }
 
@@ -207,12 +329,22 @@ JSONObject::~JSONObject()
 	}
 }
 
-void namespace_json_::JSONObject::Put(const std::string& key, JSONValue* v)
+JSONValue*& namespace_json_::JSONObject::operator[](std::string_view key)
+{
+	auto it = find(key);
+	if (it != end())
+		return it->second;
+	ownedKeys.emplace_front(key);
+	return try_emplace(ownedKeys.front(), nullptr).first->second;
+}
+
+void namespace_json_::JSONObject::Put(std::string_view key, JSONValue* v)
 {
 	auto it = find(key);
 	if (it == end())
 	{
-		insert(std::make_pair(key, v));
+		ownedKeys.emplace_front(key);
+		try_emplace(ownedKeys.front(), v);
 	}
 	else {
 		delete it->second;
@@ -220,25 +352,38 @@ void namespace_json_::JSONObject::Put(const std::string& key, JSONValue* v)
 	}
 }
 
-bool namespace_json_::JSONObject::Has(const std::string& key) const
+void namespace_json_::JSONObject::PutRef(std::string_view key, JSONValue* v)
+{
+	auto r = try_emplace(key, v);
+	if (!r.second) {
+		delete r.first->second;
+		r.first->second = v;
+	}
+}
+
+bool namespace_json_::JSONObject::Has(std::string_view key) const
 {
 	return count(key);
 }
 
-std::string namespace_json_::JSONObject::Repr() const
+void namespace_json_::JSONObject::AppendRepr(std::string& out) const
 {
 	if (empty()) {
-		return "{}";
+		out += "{}";
+		return;
 	}
-	const std::string sep = ", ";
-	std::ostringstream rep;
 	auto it = cbegin(), end = this->cend();
-	rep << '{' << (it->first) << ':' << it->second->Repr(); //escape 필요
-	for (; it != end; ++it) {
-		rep << sep << (it->first) << ':' << it->second->Repr(); //escape 필요
+	out.push_back('{');
+	AppendEscaped(out, it->first);
+	out.push_back(':');
+	it->second->AppendRepr(out);
+	for (++it; it != end; ++it) {
+		out += ", ";
+		AppendEscaped(out, it->first);
+		out.push_back(':');
+		it->second->AppendRepr(out);
 	}
-	rep << '}';
-	return rep.str();
+	out.push_back('}');
 }
 
 bool namespace_json_::JSONObject::Equal(JSONValue* o) const
@@ -255,10 +400,12 @@ bool namespace_json_::JSONObject::Equal(JSONValue* o) const
 		return false;
 	}
 
-	const auto compare_pair = [](value_type const& v1, value_type const& v2) {
-		return v1.first == v2.first && v1.second->Equal(v2.second);
-	};
-	return std::equal(begin(), end(), O->begin(), compare_pair);
+	for (const auto& kv : *this) { //멤버 순서는 비교하지 않음
+		auto it = O->find(kv.first);
+		if (it == O->end() || !kv.second->Equal(it->second))
+			return false;
+	}
+	return true;
 }
 
 JSONValue* JSONObject::Clone() const
@@ -266,14 +413,120 @@ JSONValue* JSONObject::Clone() const
 	return new JSONObject(*this);
 }
 
+static char* EncodeUTF8(char* out, unsigned long cp)
+{
+	if (cp < 0x80) {
+		*out++ = static_cast<char>(cp);
+	}
+	else if (cp < 0x800) {
+		*out++ = static_cast<char>(0xC0 | (cp >> 6));
+		*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+	}
+	else if (cp < 0x10000) {
+		*out++ = static_cast<char>(0xE0 | (cp >> 12));
+		*out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+	}
+	else {
+		*out++ = static_cast<char>(0xF0 | (cp >> 18));
+		*out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+		*out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+	}
+	return out;
+}
+
+static unsigned long ReadHex4(const char* p)
+{
+	unsigned long v = 0;
+	for (int i = 0; i < 4; i++) {
+		const char c = p[i];
+		v <<= 4;
+		if (c >= '0' && c <= '9')
+			v |= c - '0';
+		else if (c >= 'a' && c <= 'f')
+			v |= c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			v |= c - 'A' + 10;
+		else
+			throw runtime_error("Invalid unicode escape");
+	}
+	return v;
+}
+
+//buffer(여는 따옴표 다음)부터 닫는 따옴표까지를 제자리에서 이스케이프 해제
+//결과는 buffer 안을 가리키고 '\0'으로 끝남. 출력은 항상 입력보다 짧으므로 덮어써도 안전
+string_view UnescapeInSitu(char* buffer, char*& next)
+{
+	char* read = buffer;
+	while (*read != '"' && *read != '\\') { //이스케이프가 없는 앞부분은 복사하지 않음
+		if (*read == '\0')
+			throw runtime_error("Can't find end of string");
+		read++;
+	}
+	char* write = read;
+
+	while (*read != '"')
+	{
+		if (*read == '\0')
+			throw runtime_error("Can't find end of string");
+		if (*read != '\\') {
+			*write++ = *read++;
+			continue;
+		}
+
+		read++;
+		switch (*read++) {
+		case '"': *write++ = '"'; break;
+		case '\\': *write++ = '\\'; break;
+		case '/': *write++ = '/'; break;
+		case 'b': *write++ = '\b'; break;
+		case 'f': *write++ = '\f'; break;
+		case 'n': *write++ = '\n'; break;
+		case 'r': *write++ = '\r'; break;
+		case 't': *write++ = '\t'; break;
+		case 'u': {
+			if (strnlen(read, 4) < 4)
+				throw runtime_error("Can't find end of string");
+			unsigned long cp = ReadHex4(read);
+			read += 4;
+			if (cp >= 0xD800 && cp < 0xDC00 && read[0] == '\\' && read[1] == 'u' && strnlen(read + 2, 4) == 4) { //surrogate pair
+				const unsigned long low = ReadHex4(read + 2);
+				if (low >= 0xDC00 && low < 0xE000) {
+					cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+					read += 6;
+				}
+			}
+			write = EncodeUTF8(write, cp);
+			break;
+		}
+		default:
+			throw runtime_error("Unknown escape sequence");
+		}
+	}
+
+	next = read + 1;
+	*write = '\0';
+	return string_view(buffer, write - buffer);
+}
+
+//UnescapeInSitu와 같지만 buffer는 그대로 두고 복사본에서 이스케이프 해제
 string ParseKey(char* buffer, char*& next)
 {
-	char* end = std::strchr(buffer, '"');
-	if (end == NULL) //TODO
-		throw runtime_error("Can't find end of string");
-	auto ofx = end - buffer;
+	char* end = buffer;
+	while (*end != '"') { //이스케이프된 따옴표는 문자열 끝이 아님
+		if (*end == '\\' && end[1] != '\0')
+			end++;
+		if (*end == '\0')
+			throw runtime_error("Can't find end of string");
+		end++;
+	}
+
+	string str(buffer, end - buffer + 1); //닫는 따옴표까지 복사
+	char* unused;
+	str.resize(UnescapeInSitu(&str[0], unused).size());
 	next = end + 1;
-	return string(buffer, ofx);
+	return str;
 }
 
 char* SkipSpaces(char* buffer)
@@ -297,12 +550,13 @@ char* SkipSpaces(char* buffer)
 	return NULL;
 }
 
-JSONObject* namespace_json_::ParseObject(char* buffer, char*& next)
+JSONObject* namespace_json_::ParseObject(char* buffer, char*& next, bool insitu)
 {
 	auto const origin = buffer;
 	auto obj = new JSONObject();
 	bool parseKey = true;
-	string key;
+	string_view key;
+	string keyCopy; //insitu가 아닐 때 key가 가리키는 복사본
 	buffer = SkipSpaces(buffer);
 	if (*buffer != '{') {
 		delete obj;
@@ -315,7 +569,13 @@ JSONObject* namespace_json_::ParseObject(char* buffer, char*& next)
 		{
 			if (*buffer == '\"')
 			{
-				key = ParseKey(buffer + 1, buffer);
+				if (insitu) {
+					key = UnescapeInSitu(buffer + 1, buffer);
+				}
+				else {
+					keyCopy = ParseKey(buffer + 1, buffer);
+					key = keyCopy;
+				}
 				buffer = std::strchr(buffer, ':');
 				buffer = SkipSpaces(buffer);
 				if (buffer == NULL) {
@@ -336,31 +596,35 @@ JSONObject* namespace_json_::ParseObject(char* buffer, char*& next)
 		}
 		else {
 			try {
+				JSONValue* v;
 				if (*buffer == '{') {
-					auto v = ParseObject(buffer, buffer);
-					obj->Put(key, v);
+					v = ParseObject(buffer, buffer, insitu);
 				}
 				else if (*buffer == '"') {
-					auto v = ParseString(buffer + 1, buffer);
-					obj->Put(key, v);
+					if (insitu)
+						v = ParseStringInSitu(buffer + 1, buffer);
+					else
+						v = ParseString(buffer + 1, buffer);
 				}
-				else if (isdigit(*buffer)) {
-					auto v = ParseNumber(buffer, buffer);
-					obj->Put(key, v);
+				else if (isdigit(*buffer) || *buffer == '-') {
+					v = ParseNumber(buffer, buffer);
 				}
 				else if (*buffer == '[') {
-					auto v = ParseArray(buffer, buffer);
-					obj->Put(key, v);
+					v = ParseArray(buffer, buffer, insitu);
 				}
 				else if (isalpha(*buffer))
 				{
-					auto v = ParseBN(buffer, buffer);
-					obj->Put(key, v);
+					v = ParseBN(buffer, buffer);
 				}
 				else
 				{
 					throw runtime_error("Uncompleted Object");
 				}
+
+				if (insitu)
+					obj->PutRef(key, v);
+				else
+					obj->Put(key, v);
 			}
 			catch (exception e)
 			{
@@ -392,47 +656,59 @@ JSONString* namespace_json_::ParseString(char* buffer, char*& next)
 	//string str(buffer, ofx);
 	//next = end+1;
 	auto str = ParseKey(buffer, next);
-	return new JSONString(str.c_str());
+	return new JSONString(str.data(), str.size());
 }
 
-JSONNumber* namespace_json_::ParseNumber(char* buffer, char*& next)
+JSONStringRef* namespace_json_::ParseStringInSitu(char* buffer, char*& next)
 {
-	string number;
-	while (*buffer != '\0')
-	{
-		if (!(isdigit(*buffer) || *buffer == '.'))
-			break;
-		number.push_back(*(buffer++));
-	}
-
-	auto fi = number.find_first_of('.');
+	return new JSONStringRef(UnescapeInSitu(buffer, next));
+}
 
-	if (fi != string::npos) {
-		if (fi != number.find_last_of('.')) // having two points
-			throw runtime_error("Unknown number format");
-		try {
-			double val = std::stof(number);
-			next = buffer;
-			return new JSONNumber(val);
-		}
-		catch (std::exception e) {
-			throw runtime_error("Unknown number format");
-		}
-	}
-	else
-	{
-		try {
-			int val = std::stoi(number);
-			next = buffer;
+JSONNumber* namespace_json_::ParseNumber(char* buffer, char*& next)
+{
+	//from_chars는 로케일과 무관하고 할당이 없으며 double을 정확히 변환함
+	char* end = buffer;
+	if (*end == '-')
+		end++;
+	while (isdigit(*end))
+		end++;
+
+	bool isFloating = false;
+	if (*end == '.') {
+		isFloating = true;
+		end++;
+		while (isdigit(*end))
+			end++;
+	}
+	if (*end == 'e' || *end == 'E') {
+		isFloating = true;
+		end++;
+		if (*end == '+' || *end == '-')
+			end++;
+		while (isdigit(*end))
+			end++;
+	}
+
+	if (!isFloating) {
+		int64_t val;
+		auto r = from_chars(buffer, end, val);
+		if (r.ec == errc() && r.ptr == end) {
+			next = end;
 			return new JSONNumber(val);
 		}
-		catch (std::exception e) {
+		if (r.ec != errc::result_out_of_range) //int64 범위를 넘으면 실수로 저장
 			throw runtime_error("Unknown number format");
-		}
 	}
+
+	double val;
+	auto r = from_chars(buffer, end, val);
+	if (r.ec != errc() || r.ptr != end)
+		throw runtime_error("Unknown number format");
+	next = end;
+	return new JSONNumber(val);
 }
 
-JSONArray* namespace_json_::ParseArray(char* buffer, char*& next)
+JSONArray* namespace_json_::ParseArray(char* buffer, char*& next, bool insitu)
 {
 	auto obj = new JSONArray();
 	buffer = SkipSpaces(buffer + 1);
@@ -440,19 +716,23 @@ JSONArray* namespace_json_::ParseArray(char* buffer, char*& next)
 	{
 		try {
 			if (*buffer == '{') {
-				auto v = ParseObject(buffer, buffer);
+				auto v = ParseObject(buffer, buffer, insitu);
 				obj->push_back(v);
 			}
 			else if (*buffer == '"') {
-				auto v = ParseString(buffer + 1, buffer);
+				JSONValue* v;
+				if (insitu)
+					v = ParseStringInSitu(buffer + 1, buffer);
+				else
+					v = ParseString(buffer + 1, buffer);
 				obj->push_back(v);
 			}
-			else if (isdigit(*buffer)) {
+			else if (isdigit(*buffer) || *buffer == '-') {
 				auto v = ParseNumber(buffer, buffer);
 				obj->push_back(v);
 			}
 			else if (*buffer == '[') {
-				auto v = ParseArray(buffer, buffer);
+				auto v = ParseArray(buffer, buffer, insitu);
 				obj->push_back(v);
 			}
 			else if (isalpha(*buffer))
@@ -508,6 +788,17 @@ JSONValue* namespace_json_::ParseBN(char* buffer, char*& next)
 	return v;
 }
 
+JSONObject* namespace_json_::ParseFile(const std::string& path)
+{
+	//파서가 '\0'으로 끝나는 쓰기 가능한 버퍼를 기대하므로 쓰기 시 복사로 매핑
+	namespace_json_2::MappedFile file(path, namespace_json_2::MappedFile::Mode::CopyOnWrite);
+	char* buffer = SkipSpaces(file.data());
+	if (buffer == NULL || *buffer != '{')
+		throw runtime_error("Object must start with '{'");
+	char* next;
+	return ParseObject(buffer, next);
+}
+
 JSONArray::JSONArray() : JSONValue(VALUE_TYPE::ARRAY)
 {
 }
@@ -541,20 +832,20 @@ void JSONArray::Remove(const JSONValue& value)
 	}
 }
 
-std::string JSONArray::Repr() const
+void JSONArray::AppendRepr(std::string& out) const
 {
 	if (empty()) {
-		return "[]";
+		out += "[]";
+		return;
 	}
-	const std::string sep = ", ";
-	std::ostringstream rep;
 	auto it = cbegin(), end = this->cend();
-	rep << '[' << (*it++)->Repr();
+	out.push_back('[');
+	(*it++)->AppendRepr(out);
 	for (; it != end; ++it) {
-		rep << sep << (*it)->Repr();
+		out += ", ";
+		(*it)->AppendRepr(out);
 	}
-	rep << ']';
-	return rep.str();
+	out.push_back(']');
 }
 
 bool JSONArray::Equal(JSONValue* o) const
@@ -1,10 +1,13 @@
 #include <string.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <vector>
 #include <tchar.h>
 #define _MBCS
 #include <string>
-#include <map>
+#include <string_view>
+#include <forward_list>
+#include "ordered_map.hpp"
 
 constexpr double CompareError = 1e-3;
 inline bool CompareFloats(const double& x, const double& y);
@@ -13,6 +16,7 @@ namespace namespace_json_ {
 	enum class VALUE_TYPE {
 		NUMBER,
 		STRING,
+		STRING_REF,
 		BOOLEAN,
 		ARRAY,
 		JNULL,
@@ -25,7 +29,8 @@ namespace namespace_json_ {
 	protected:
 		JSONValue(VALUE_TYPE type) noexcept;
 	public:
-		virtual std::string Repr() const = 0;
+		std::string Repr() const;
+		virtual void AppendRepr(std::string& out) const = 0; //out 뒤에 이어 씀
 		virtual JSONValue* Clone() const = 0;
 		virtual bool Equal(JSONValue* o) const = 0;
 		virtual ~JSONValue() {}
@@ -35,22 +40,25 @@ namespace namespace_json_ {
 		bool isFloating;
 		union {
 			double fVal;
-			int iVal;
+			int64_t iVal;
 		};
 	public:
 		JSONNumber() = delete;
 		JSONNumber(const double& v) noexcept;
 		JSONNumber(const int& v) noexcept;
+		JSONNumber(const int64_t& v) noexcept;
 		JSONNumber(const JSONNumber& o) noexcept;
 		JSONNumber(JSONNumber&&) = delete;
 
 		void Put(const double& v) noexcept;
 		void Put(const int& v) noexcept;
+		void Put(const int64_t& v) noexcept;
 		bool IsFloating() const noexcept;
 		double GetAsFloat() const;
 		int GetAsInt() const;
+		int64_t GetAsInt64() const;
 
-		std::string Repr() const override;
+		void AppendRepr(std::string& out) const override;
 		virtual bool Equal(JSONValue* o) const;
 		virtual JSONValue* Clone() const;
 	};
@@ -59,6 +67,7 @@ namespace namespace_json_ {
 	public:
 		JSONString() = delete;
 		JSONString(const char* str);
+		JSONString(const char* str, size_t length);
 		JSONString(const JSONString& o);
 		JSONString(JSONString&&) = delete;
 		~JSONString();
@@ -69,11 +78,24 @@ namespace namespace_json_ {
 
 		void Put(const char* str); //Use *ptr = ~
 
-		std::string Repr() const override;
+		void AppendRepr(std::string& out) const override;
 		virtual bool Equal(JSONValue* o) const;
 		virtual JSONValue* Clone() const;
 	};
 
+	//in-situ 파싱 결과. 호출자의 버퍼를 가리키므로 버퍼가 문서보다 오래 살아야 함
+	class JSONStringRef : public JSONValue, public std::string_view {
+	public:
+		JSONStringRef() = delete;
+		JSONStringRef(std::string_view str) noexcept;
+		JSONStringRef(const JSONStringRef& o) noexcept;
+		JSONStringRef(JSONStringRef&&) = delete;
+
+		void AppendRepr(std::string& out) const override;
+		bool Equal(JSONValue* o) const override;
+		JSONValue* Clone() const override;
+	};
+
 	class JSONBoolean : public JSONValue {
 		bool value;
 	public:
@@ -82,7 +104,7 @@ namespace namespace_json_ {
 		JSONBoolean(const JSONBoolean& o) noexcept;
 		JSONBoolean(JSONBoolean&&) = delete;
 
-		std::string Repr() const override;
+		void AppendRepr(std::string& out) const override;
 		bool Equal(JSONValue* o) const override;
 		JSONValue* Clone() const override;
 	};
@@ -98,7 +120,7 @@ namespace namespace_json_ {
 		void Remove(const JSONValue& value);
 
 
-		std::string Repr() const override;
+		void AppendRepr(std::string& out) const override;
 		bool Equal(JSONValue* o) const override;
 		JSONValue* Clone() const override;
 	};
@@ -109,29 +131,53 @@ namespace namespace_json_ {
 		JSONNull(const JSONNull&) = delete;
 		JSONNull(JSONNull&&) = delete;
 
-		std::string Repr() const override;
+		void AppendRepr(std::string& out) const override;
 		bool Equal(JSONValue* o) const override;
 		JSONValue* Clone() const override;
 	};
 
-	class JSONObject : public JSONValue, public std::map<std::string, JSONValue*> {
+	//키는 string_view. Put으로 넣은 키는 객체가 소유하고, PutRef로 넣은 키는 외부 버퍼를 가리킴
+	//멤버는 삽입 순서대로 저장되고 출력됨
+	//삽입은 Put/PutRef로만 함. 임시 문자열이 키로 남지 않도록 읽기용 멤버만 공개
+	class JSONObject : public JSONValue, private namespace_json_2::OrderedMap<std::string_view, JSONValue*> {
+		using base_map = namespace_json_2::OrderedMap<std::string_view, JSONValue*>;
+		std::forward_list<std::string> ownedKeys;
 	public:
+		using base_map::value_type;
+		using base_map::iterator;
+		using base_map::const_iterator;
+		using base_map::begin;
+		using base_map::end;
+		using base_map::cbegin;
+		using base_map::cend;
+		using base_map::size;
+		using base_map::empty;
+		using base_map::find;
+		using base_map::count;
+
 		JSONObject();
 		JSONObject(const JSONObject& o);
 		JSONObject(JSONObject&&) = delete;
 		~JSONObject();
 
-		void Put(const std::string& key, JSONValue* v);
-		bool Has(const std::string& key) const;
+		JSONValue*& operator[](std::string_view key); //없는 키는 복사해서 nullptr 값으로 추가
+		void Put(std::string_view key, JSONValue* v);
+		void PutRef(std::string_view key, JSONValue* v);
+		bool Has(std::string_view key) const;
 
-		std::string Repr() const override;
+		void AppendRepr(std::string& out) const override;
 		bool Equal(JSONValue* o) const override;
 		JSONValue* Clone() const override;
 	};
 
-	JSONObject* ParseObject(char* buffer, char*& next);
+	//insitu: 문자열을 buffer 안에서 이스케이프 해제하고 JSONStringRef와 키로 그대로 가리킴 (문자열 할당 없음)
+	JSONObject* ParseObject(char* buffer, char*& next, bool insitu = false);
 	JSONString* ParseString(char* buffer, char*& next);
+	JSONStringRef* ParseStringInSitu(char* buffer, char*& next);
 	JSONNumber* ParseNumber(char* buffer, char*& next);
-	JSONArray* ParseArray(char* buffer, char*& next);
+	JSONArray* ParseArray(char* buffer, char*& next, bool insitu = false);
 	JSONValue* ParseBN(char* buffer, char*& next);
+
+	//파일을 쓰기 시 복사로 매핑해서 읽음 (힙에 전체를 복사하지 않음). 매핑은 파싱이 끝나면 해제됨
+	JSONObject* ParseFile(const std::string& path);
 }
@@ -1,11 +1,26 @@
+#pragma once
 #include <string.h>
+#include <cstdio>
 #include <stdexcept>
 #include <sstream>
 #include <functional>
 #include <vector>
 #include <string>
-#include <map>
+#include <string_view>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <memory_resource>
 #include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include "structural_index.hpp"
+#include "ordered_map.hpp"
 
 #ifndef XFAST_CONV
 
@@ -27,7 +42,154 @@ namespace namespace_json_2 {
 		OBJECT,
 	};
 
+	class JBuffer;
+	class Document;
+	class KeyPool;
+
+	//nullptr이면 기본 힙 할당자
+	inline std::pmr::memory_resource* ResourceOr(std::pmr::memory_resource* mr) noexcept
+	{
+		return mr != nullptr ? mr : std::pmr::get_default_resource();
+	}
+
+	class JValue;
+
+	//파싱 정책. JParser 등의 템플릿 인자로 넘기며 정책마다 필요한 검사만 컴파일됨
+	//한 프로그램 안에서 입력마다 다른 정책을 쓸 수 있음
+	//Strict: 표준 JSON만 허용하고 형식을 모두 검사
+	struct StrictPolicy {
+		static constexpr bool single_quotes = false; //'문자열'
+		static constexpr bool unquoted_keys = false; //따옴표 없는 키 (':' 앞까지)
+		static constexpr bool optional_brackets = false; //여는 괄호 생략 (ParseArray, ParseObject를 바로 부를 때)
+		static constexpr bool validate = true; //문자열 시작, 괄호, 숫자 부호 검사
+		static constexpr bool trust_input = false; //':'와 리터럴 철자 검사 생략
+	};
+
+	//Lenient: 작은따옴표 문자열, 따옴표 없는 키, 여는 괄호 생략을 허용
+	struct LenientPolicy {
+		static constexpr bool single_quotes = true;
+		static constexpr bool unquoted_keys = true;
+		static constexpr bool optional_brackets = true;
+		static constexpr bool validate = false;
+		static constexpr bool trust_input = false;
+	};
+
+	//Trusted: 올바른 JSON이라고 믿고 형식 검사를 생략. 내부에서 만든 입력에만 사용
+	//잘못된 입력은 예외 없이 틀린 결과를 낼 수 있음 (스트림 끝 검사는 유지)
+	struct TrustedPolicy {
+		static constexpr bool single_quotes = false;
+		static constexpr bool unquoted_keys = false;
+		static constexpr bool optional_brackets = false;
+		static constexpr bool validate = false;
+		static constexpr bool trust_input = true;
+	};
+
+	//정책을 지정하지 않은 파싱 함수가 쓰는 정책
+#ifdef PARSE_STRICT_CHECK
+	using DefaultPolicy = StrictPolicy;
+#else
+	using DefaultPolicy = LenientPolicy;
+#endif
+
+	//직렬화 출력. 호출자가 준 std::string 뒤에 이어 쓰므로 버퍼를 재사용하면 할당이 거의 없음
+	class JWriter {
+		std::string& out;
+
+		void Escape(char c)
+		{
+			switch (c) {
+			case '"':
+				out.append("\\\"", 2);
+				break;
+			case '\\':
+				out.append("\\\\", 2);
+				break;
+			case '/':
+				out.append("\\/", 2);
+				break;
+			case '\b':
+				out.append("\\b", 2);
+				break;
+			case '\f':
+				out.append("\\f", 2);
+				break;
+			case '\n':
+				out.append("\\n", 2);
+				break;
+			case '\r':
+				out.append("\\r", 2);
+				break;
+			case '\t':
+				out.append("\\t", 2);
+				break;
+			default: { //나머지 제어 문자
+				static const char hex[] = "0123456789abcdef";
+				const char u[] = { '\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF] };
+				out.append(u, sizeof(u));
+			}
+			}
+		}
+	public:
+		explicit JWriter(std::string& out) noexcept : out(out) {}
+		JWriter(const JWriter&) = delete;
+
+		std::string& Buffer() noexcept { return out; }
+
+		void Raw(char c)
+		{
+			out.push_back(c);
+		}
+
+		void Raw(std::string_view s)
+		{
+			out.append(s.data(), s.size());
+		}
+
+		//따옴표로 감싸고 이스케이프. 이스케이프가 필요 없는 구간은 한 번에 복사
+		void String(std::string_view s)
+		{
+			out.push_back('"');
+			const char* p = s.data();
+			const char* const last = p + s.size();
+			while (true) {
+				const char* q = FindEscape(p, last);
+				out.append(p, q - p);
+				if (q == last)
+					break;
+				Escape(*q);
+				p = q + 1;
+			}
+			out.push_back('"');
+		}
+
+		void Number(int64_t v)
+		{
+			char buf[24];
+			out.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr - buf);
+		}
+
+		void Number(uint64_t v)
+		{
+			char buf[24];
+			out.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr - buf);
+		}
+
+		void Number(double v)
+		{
+			if (!std::isfinite(v)) { //JSON에는 무한대와 NaN이 없음
+				out.append("null", 4);
+				return;
+			}
+			char buf[32]; //다시 읽으면 같은 값이 되는 가장 짧은 표현
+			out.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr - buf);
+		}
+
+		void Value(const JValue* v);
+	};
+
 	class JValue {
+		friend class Document;
+		bool in_arena = false;
 	public:
 		const VALUE_TYPE type;
 	protected:
@@ -38,17 +200,52 @@ namespace namespace_json_2 {
 
 		std::string to_string() const
 		{
-			std::ostringstream os;
-			Repr(os);
-			return os.str();
+			std::string out;
+			JWriter w(out);
+			Write(w);
+			return out;
+		}
+
+		std::ostream& Repr(std::ostream& os) const
+		{
+			const std::string s = to_string();
+			return os.write(s.data(), s.size());
 		}
 
-		virtual std::ostream& Repr(std::ostream& os) const = 0;
+		virtual void Write(JWriter& w) const = 0;
 		virtual JValue* Clone() const = 0;
 		virtual bool Equal(JValue* o) const = 0;
 		virtual ~JValue() {}
 
+		//mr이 주어지면 arena에 생성. arena 노드는 delete하지 말고 Release로 해제
+		template <typename T, typename... Args>
+		static T* Create(std::pmr::memory_resource* mr, Args&&... args)
+		{
+			if (mr == nullptr)
+				return new T(std::forward<Args>(args)...);
+			T* v = new (mr->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+			v->in_arena = true;
+			return v;
+		}
+
+		//arena 노드는 소멸자만 호출하고 메모리는 arena와 함께 반환
+		static void Release(JValue* v) noexcept
+		{
+			if (v == nullptr)
+				return;
+			if (v->in_arena)
+				v->~JValue();
+			else
+				delete v;
+		}
+
 		static JValue* Parse(std::istream& is);
+		static JValue* Parse(JBuffer& is);
+		static JValue* Parse(std::string_view str, const StructuralIndex* index = nullptr);
+		static JValue* Parse(const char* data, size_t size, const StructuralIndex* index = nullptr);
+		//keys가 주어지면 객체 키를 공유 풀에 등록 (풀이 값보다 오래 살아야 함)
+		template <typename Policy = DefaultPolicy, typename Reader>
+		static JValue* ParseWith(Reader& is, std::pmr::memory_resource* mr = nullptr, KeyPool* keys = nullptr);
 	};
 
 	std::ostream& operator<<(std::ostream& os, const JValue* v) {
@@ -59,52 +256,122 @@ namespace namespace_json_2 {
 		return v.Repr(os);
 	}
 
+	inline void JWriter::Value(const JValue* v)
+	{
+		v->Write(*this);
+	}
+
 	using JFloat = double;
 	class JNumber : public JValue {
-		bool isFloat;
+	public:
+		enum class KIND : char {
+			INT, //int64_t
+			UINT, //int64_t 범위를 넘는 uint64_t
+			FLOAT
+		};
+	private:
+		KIND kind;
 		union {
-			int iVal;
+			int64_t iVal;
+			uint64_t uVal;
 			JFloat fVal;
 		};
 	public:
-		JNumber() noexcept : JValue(VALUE_TYPE::NUMBER), iVal(0), isFloat(false) {}
-		JNumber(const JFloat& v) noexcept : JValue(VALUE_TYPE::NUMBER), fVal(v), isFloat(true) {}
-		JNumber(const int& v) noexcept : JValue(VALUE_TYPE::NUMBER), iVal(v), isFloat(false) {}
-		JNumber(const JNumber& o) noexcept : JValue(VALUE_TYPE::NUMBER), fVal{ o.fVal }, isFloat(o.isFloat) {}
+		JNumber() noexcept : JValue(VALUE_TYPE::NUMBER), kind(KIND::INT), iVal(0) {}
+		JNumber(const JFloat& v) noexcept : JValue(VALUE_TYPE::NUMBER), kind(KIND::FLOAT), fVal(v) {}
+		JNumber(const int& v) noexcept : JValue(VALUE_TYPE::NUMBER), kind(KIND::INT), iVal(v) {}
+		JNumber(const int64_t& v) noexcept : JValue(VALUE_TYPE::NUMBER), kind(KIND::INT), iVal(v) {}
+		JNumber(const uint64_t& v) noexcept : JValue(VALUE_TYPE::NUMBER)
+		{
+			Set(v);
+		}
+		JNumber(const JNumber& o) noexcept : JValue(VALUE_TYPE::NUMBER), kind(o.kind), uVal{ o.uVal } {}
 
 		void Set(const int& v) noexcept
 		{
-			isFloat = false;
+			Set(static_cast<int64_t>(v));
+		}
+
+		void Set(const int64_t& v) noexcept
+		{
+			kind = KIND::INT;
 			iVal = v;
 		}
 
+		void Set(const uint64_t& v) noexcept
+		{
+			if (v > static_cast<uint64_t>(INT64_MAX)) {
+				kind = KIND::UINT;
+				uVal = v;
+			}
+			else {
+				kind = KIND::INT;
+				iVal = static_cast<int64_t>(v);
+			}
+		}
+
 		void Set(const JFloat& v) noexcept
 		{
-			isFloat = true;
+			kind = KIND::FLOAT;
 			fVal = v;
 		}
 
 		JNumber& operator=(const int& v) noexcept
 		{
-			isFloat = false;
-			iVal = v;
+			Set(v);
+			return *this;
+
+		}
+
+		JNumber& operator=(const int64_t& v) noexcept
+		{
+			Set(v);
 			return *this;
+		}
 
+		JNumber& operator=(const uint64_t& v) noexcept
+		{
+			Set(v);
+			return *this;
 		}
 
 		JNumber& operator=(const JFloat& v) noexcept
 		{
-			isFloat = true;
-			fVal = v;
+			Set(v);
 			return *this;
 		}
 
+		KIND Kind() const noexcept { return kind; }
+		bool IsFloat() const noexcept { return kind == KIND::FLOAT; }
+
 		JFloat asFloat() const noexcept {
-			return isFloat ? fVal : static_cast<JFloat>(iVal);
+			switch (kind) {
+			case KIND::FLOAT:
+				return fVal;
+			case KIND::UINT:
+				return static_cast<JFloat>(uVal);
+			default:
+				return static_cast<JFloat>(iVal);
+			}
+		}
+
+		int64_t asInt64() const noexcept {
+			switch (kind) {
+			case KIND::FLOAT:
+				return static_cast<int64_t>(fVal);
+			case KIND::UINT:
+				return static_cast<int64_t>(uVal);
+			default:
+				return iVal;
+			}
+		}
+
+		uint64_t asUInt64() const noexcept {
+			return kind == KIND::FLOAT ? static_cast<uint64_t>(fVal) : uVal;
 		}
 
 		int asInt() const noexcept {
-			return isFloat ? static_cast<int>(fVal) : iVal;
+			return static_cast<int>(asInt64());
 		}
 
 		operator JFloat() const noexcept {
@@ -116,10 +383,18 @@ namespace namespace_json_2 {
 			return asInt();
 		}
 
-		std::ostream& Repr(std::ostream& os) const override
+		void Write(JWriter& w) const override
 		{
-			os << (isFloat ? fVal : iVal);
-			return os;
+			switch (kind) {
+			case KIND::FLOAT:
+				w.Number(fVal);
+				break;
+			case KIND::UINT:
+				w.Number(uVal);
+				break;
+			default:
+				w.Number(iVal);
+			}
 		}
 
 		bool Equal(JValue* o) const override
@@ -132,10 +407,10 @@ namespace namespace_json_2 {
 			}
 
 			auto n = reinterpret_cast<JNumber*>(o);
-			if (n->isFloat || isFloat)
+			if (n->kind == KIND::FLOAT || kind == KIND::FLOAT)
 				return CompareFloats(asFloat(), n->asFloat());
 			else
-				return n->iVal == iVal;
+				return n->kind == kind && n->uVal == uVal;
 		}
 		JValue* Clone() const override
 		{
@@ -149,28 +424,37 @@ namespace namespace_json_2 {
 		}
 
 		static JNumber* Parse(std::istream& is);
+		static JNumber* Parse(JBuffer& is);
+		template <typename Policy = DefaultPolicy, typename Reader>
+		static JNumber* ParseWith(Reader& is, std::pmr::memory_resource* mr = nullptr);
 	};
 
-	static std::string EscapeString(const std::string& s);
-	class JString : public JValue, public std::string {
+	static std::string EscapeString(std::string_view s);
+	class JString : public JValue, public std::pmr::string {
 	public:
 		JString() : JValue(VALUE_TYPE::STRING) {}
-		JString(const char* str) : JValue(VALUE_TYPE::STRING), std::string(str) {}
-		JString(const std::string& str) : JValue(VALUE_TYPE::STRING), std::string(str) {}
-		JString(std::string&& rstr) : JValue(VALUE_TYPE::STRING), std::string(rstr) {}
-		JString(const JString& o) : JValue(VALUE_TYPE::STRING), std::string(o) {}
-
-		using std::string::operator=;
-		using std::string::operator+=;
-		using std::string::operator[];
+		explicit JString(std::pmr::memory_resource* mr) : JValue(VALUE_TYPE::STRING), std::pmr::string(ResourceOr(mr)) {}
+		JString(const char* str) : JValue(VALUE_TYPE::STRING), std::pmr::string(str) {}
+		JString(const std::string& str) : JValue(VALUE_TYPE::STRING), std::pmr::string(str.data(), str.size()) {}
+		JString(std::string_view str, std::pmr::memory_resource* mr) : JValue(VALUE_TYPE::STRING), std::pmr::string(str, ResourceOr(mr)) {}
+		JString(const JString& o) : JValue(VALUE_TYPE::STRING), std::pmr::string(o, std::pmr::get_default_resource()) {}
+
+		using std::pmr::string::operator=;
+		using std::pmr::string::operator+=;
+		using std::pmr::string::operator[];
 		void Set(const char* str)
 		{
-			static_cast<std::string*>(this)->operator=(str);
+			static_cast<std::pmr::string*>(this)->operator=(str);
+		}
+
+		operator std::string() const
+		{
+			return std::string(data(), size());
 		}
 
-		std::ostream& Repr(std::ostream& os) const override
+		void Write(JWriter& w) const override
 		{
-			return os << EscapeString(*this);
+			w.String(*this);
 		}
 		bool Equal(JValue* o) const override
 		{
@@ -190,28 +474,35 @@ namespace namespace_json_2 {
 		}
 
 		static JString* Parse(std::istream& is);
+		static JString* Parse(JBuffer& is);
+		template <typename Policy = DefaultPolicy, typename Reader>
+		static JString* ParseWith(Reader& is, std::pmr::memory_resource* mr = nullptr);
 		static std::string ParseString(std::istream& is);
+		static std::string ParseString(JBuffer& is);
+		template <typename Policy = DefaultPolicy, typename Reader, typename Str>
+		static void ParseStringInto(Reader& is, Str& str);
 	};
 
-	class JArray : public JValue, public std::vector<JValue*> {
+	class JArray : public JValue, public std::pmr::vector<JValue*> {
 	public:
 		JArray() noexcept : JValue(VALUE_TYPE::ARRAY) {}
+		explicit JArray(std::pmr::memory_resource* mr) noexcept : JValue(VALUE_TYPE::ARRAY), std::pmr::vector<JValue*>(ResourceOr(mr)) {}
 		~JArray()
 		{
 			for (const auto& e : *this)
 			{
-				delete e;
+				Release(e);
 			}
 		}
 
-		using std::vector<JValue*>::operator[];
+		using std::pmr::vector<JValue*>::operator[];
 		void Remove(JValue* item)
 		{
 			auto it = find(begin(), end(), item);
 			if (it != end())
 			{
 				if (*it != item)
-					delete *it;
+					Release(*it);
 				erase(it);
 			}
 		}
@@ -224,25 +515,25 @@ namespace namespace_json_2 {
 			auto it = find_if(begin(), end(), cmp);
 			if (it != end())
 			{
-				delete *it;
+				Release(*it);
 				erase(it);
 			}
 		}
 
-		std::ostream& Repr(std::ostream& os) const override
+		void Write(JWriter& w) const override
 		{
 			if (empty()) {
-				os << "[]";
-				return os;
+				w.Raw("[]");
+				return;
 			}
-			const std::string sep = ", ";
 			auto it = cbegin(), end = this->cend();
-			os << '[' << (*it++);
+			w.Raw('[');
+			w.Value(*it++);
 			for (; it != end; ++it) {
-				os << sep << (*it);
+				w.Raw(", ");
+				w.Value(*it);
 			}
-			os << ']';
-			return os;
+			w.Raw(']');
 		}
 		bool Equal(JValue* o) const override
 		{
@@ -261,7 +552,7 @@ namespace namespace_json_2 {
 			}
 
 			for (size_t i = 0; i < size; i++) {
-				if (this->at(i) != O->at(i)) {
+				if (!this->at(i)->Equal(O->at(i))) {
 					return false;
 				}
 			}
@@ -279,66 +570,259 @@ namespace namespace_json_2 {
 		}
 
 		static JArray* Parse(std::istream& is);
+		static JArray* Parse(JBuffer& is);
+		template <typename Policy = DefaultPolicy, typename Reader>
+		static JArray* ParseWith(Reader& is, std::pmr::memory_resource* mr = nullptr);
+	};
+
+	//std::string, string_view, const char* 어느 것으로도 키를 찾을 수 있도록
+	//여러 문서가 함께 쓰는 키 문자열 저장소. 같은 내용은 한 번만 저장되며 주소가 바뀌지 않음
+	//여러 스레드의 파서가 동시에 써도 안전함. 등록된 키를 쓰는 문서보다 오래 살아 있어야 함
+	class KeyPool {
+		static constexpr size_t shard_count = 16; //잠금 경합을 줄이기 위해 해시로 나눔
+
+		struct Shard {
+			std::mutex lock;
+			std::unordered_set<std::string_view> keys;
+			std::pmr::monotonic_buffer_resource storage;
+		};
+		Shard shards[shard_count];
+	public:
+		KeyPool() = default;
+		KeyPool(const KeyPool&) = delete;
+
+		std::string_view Intern(std::string_view key)
+		{
+			const size_t hash = std::hash<std::string_view>()(key);
+			Shard& shard = shards[(hash >> 7) % shard_count];
+			std::lock_guard<std::mutex> lk(shard.lock);
+			auto it = shard.keys.find(key);
+			if (it != shard.keys.end())
+				return *it;
+
+			char* p = static_cast<char*>(shard.storage.allocate(key.size() + 1, 1));
+			memcpy(p, key.data(), key.size());
+			p[key.size()] = '\0';
+			return *shard.keys.emplace(p, key.size()).first;
+		}
+
+		size_t size()
+		{
+			size_t n = 0;
+			for (auto& shard : shards) {
+				std::lock_guard<std::mutex> lk(shard.lock);
+				n += shard.keys.size();
+			}
+			return n;
+		}
+	};
+
+	//객체의 키. KeyPool의 문자열을 가리키거나(소유하지 않음), 객체의 메모리 자원에 복사본을 소유함
+	//같은 풀에서 온 키끼리는 주소만으로 같은지 판단됨
+	class JKey {
+		const char* ptr = "";
+		size_t len = 0;
+		std::pmr::memory_resource* owner = nullptr; //nullptr이면 소유하지 않음
+
+		void CopyFrom(std::string_view s, std::pmr::memory_resource* mr)
+		{
+			if (s.empty())
+				return;
+			char* p = static_cast<char*>(mr->allocate(s.size(), 1));
+			memcpy(p, s.data(), s.size());
+			ptr = p;
+			len = s.size();
+			owner = mr;
+		}
+
+		void Free() noexcept
+		{
+			if (owner != nullptr)
+				owner->deallocate(const_cast<char*>(ptr), len, 1);
+			ptr = "";
+			len = 0;
+			owner = nullptr;
+		}
+	public:
+		using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+		JKey() noexcept = default;
+		JKey(std::string_view s, const allocator_type& a = {})
+		{
+			CopyFrom(s, a.resource());
+		}
+		JKey(const JKey& o, const allocator_type& a = {})
+		{
+			if (o.owner == nullptr)
+				*this = Interned(o);
+			else
+				CopyFrom(o, a.resource());
+		}
+		JKey(JKey&& o) noexcept : ptr(o.ptr), len(o.len), owner(o.owner)
+		{
+			o.ptr = "";
+			o.len = 0;
+			o.owner = nullptr;
+		}
+		JKey(JKey&& o, const allocator_type& a)
+		{
+			if (o.owner == nullptr || o.owner->is_equal(*a.resource()))
+				*this = std::move(o);
+			else
+				CopyFrom(o, a.resource());
+		}
+		~JKey()
+		{
+			Free();
+		}
+
+		JKey& operator=(JKey&& o) noexcept
+		{
+			if (this != &o) {
+				Free();
+				ptr = o.ptr;
+				len = o.len;
+				owner = o.owner;
+				o.ptr = "";
+				o.len = 0;
+				o.owner = nullptr;
+			}
+			return *this;
+		}
+		JKey& operator=(const JKey&) = delete;
+
+		//pooled는 KeyPool::Intern이 반환한 문자열처럼 키보다 오래 사는 저장소여야 함
+		static JKey Interned(std::string_view pooled) noexcept
+		{
+			JKey k;
+			k.ptr = pooled.data();
+			k.len = pooled.size();
+			return k;
+		}
+
+		bool IsInterned() const noexcept { return owner == nullptr; }
+		const char* data() const noexcept { return ptr; }
+		size_t size() const noexcept { return len; }
+		operator std::string_view() const noexcept { return std::string_view(ptr, len); }
+		operator std::string() const { return std::string(ptr, len); }
+
+		friend bool operator==(const JKey& a, std::string_view b) noexcept
+		{
+			return std::string_view(a) == b;
+		}
+		friend bool operator!=(const JKey& a, std::string_view b) noexcept
+		{
+			return std::string_view(a) != b;
+		}
+		friend std::ostream& operator<<(std::ostream& os, const JKey& k)
+		{
+			return os << std::string_view(k);
+		}
 	};
 
-	class JObject : public JValue, public std::map<std::string, JValue*> {
+	//멤버는 입력(삽입) 순서대로 저장되고 출력됨
+	class JObject : public JValue, public OrderedMap<JKey, JValue*, std::pmr::polymorphic_allocator<std::pair<JKey, JValue*>>> {
+		using base_map = OrderedMap<JKey, JValue*, std::pmr::polymorphic_allocator<std::pair<JKey, JValue*>>>;
 		static inline bool checkName(const std::string& name)
 		{
 			return std::all_of(name.cbegin(), name.cend(), std::isalpha);
 		}
 	public:
 		JObject() noexcept : JValue(VALUE_TYPE::OBJECT) {}
-		JObject(const JObject& o) : JValue(VALUE_TYPE::OBJECT) {}
+		explicit JObject(std::pmr::memory_resource* mr) noexcept : JValue(VALUE_TYPE::OBJECT), base_map(ResourceOr(mr)) {}
+		JObject(const JObject& o) : JValue(VALUE_TYPE::OBJECT), base_map(std::pmr::get_default_resource())
+		{
+			reserve(o.size());
+			try {
+				for (const auto& kv : o)
+					try_emplace(kv.first, kv.second->Clone());
+			}
+			catch (...) {
+				for (const auto& kv : *this)
+					Release(kv.second);
+				throw;
+			}
+		}
 		~JObject()
 		{
 			for (const auto& kv : *this)
 			{
-				delete kv.second;
+				Release(kv.second);
 			}
 		}
 
-		void Set(const std::string& key, JValue* v)
+		void Set(std::string_view key, JValue* v)
 		{
-			auto it = find(key);
-			if (it == end())
-			{
-				insert(std::make_pair(key, v));
+			auto r = try_emplace(key, v);
+			if (!r.second) {
+				Release(r.first->second);
+				r.first->second = v;
 			}
-			else {
-				delete it->second;
-				it->second = v;
+		}
+
+		//KeyPool에 등록된 키 등 이미 만든 키를 그대로 사용
+		void Set(JKey&& key, JValue* v)
+		{
+			auto r = try_emplace(std::move(key), v);
+			if (!r.second) {
+				Release(r.first->second);
+				r.first->second = v;
 			}
 		}
 
-		void Remove(const std::string& key) {
+		void Remove(std::string_view key) {
 			auto it = find(key);
 			if (it != end())
 			{
-				delete it->second;
+				Release(it->second);
 				erase(it);
 			}
 		}
 
-		bool Has(const std::string& key) const
+		bool Has(std::string_view key) const
 		{
 			return count(key);
 		}
-		using std::map<std::string, JValue*>::operator[];
 
-		std::ostream& Repr(std::ostream& os) const override
+		JValue*& operator[](std::string_view key)
+		{
+			return base_map::operator[](key);
+		}
+
+		JValue*& at(std::string_view key)
+		{
+			auto it = find(key);
+			if (it == end())
+				throw std::out_of_range("키가 없습니다");
+			return it->second;
+		}
+
+		JValue* at(std::string_view key) const
+		{
+			auto it = find(key);
+			if (it == end())
+				throw std::out_of_range("키가 없습니다");
+			return it->second;
+		}
+
+		void Write(JWriter& w) const override
 		{
 			if (empty()) {
-				os << "{}";
-				return os;
+				w.Raw("{}");
+				return;
 			}
-			const std::string sep = ", ";
 			auto it = cbegin(), end = this->cend();
-			os << '{' << EscapeString(it->first) << ':' << it->second; ++it;
-			for (; it != end; ++it) {
-				os << sep << EscapeString(it->first) << ':' << it->second;
+			w.Raw('{');
+			w.String(it->first);
+			w.Raw(':');
+			w.Value(it->second);
+			for (++it; it != end; ++it) {
+				w.Raw(", ");
+				w.String(it->first);
+				w.Raw(':');
+				w.Value(it->second);
 			}
-			os << '}';
-			return os;
+			w.Raw('}');
 		}
 		bool Equal(JValue* o) const override
 		{
@@ -354,10 +838,12 @@ namespace namespace_json_2 {
 				return false;
 			}
 
-			const auto compare_pair = [](value_type const& v1, value_type const& v2) {
-				return v1.first == v2.first && v1.second->Equal(v2.second);
-			};
-			return std::equal(begin(), end(), O->begin(), compare_pair);
+			for (const auto& kv : *this) { //멤버 순서는 비교하지 않음
+				auto it = O->find(kv.first);
+				if (it == O->end() || !kv.second->Equal(it->second))
+					return false;
+			}
+			return true;
 		}
 		JValue* Clone() const override
 		{
@@ -365,6 +851,9 @@ namespace namespace_json_2 {
 		}
 
 		static JObject* Parse(std::istream& is);
+		static JObject* Parse(JBuffer& is);
+		template <typename Policy = DefaultPolicy, typename Reader>
+		static JObject* ParseWith(Reader& is, std::pmr::memory_resource* mr = nullptr);
 	};
 
 	class JLiteral : public JValue {
@@ -416,13 +905,12 @@ namespace namespace_json_2 {
 			return flag & mask_bool;
 		}
 
-		std::ostream& Repr(std::ostream& os) const override
+		void Write(JWriter& w) const override
 		{
 			if (IsNull())
-				os << "null";
+				w.Raw("null");
 			else
-				os << (Bool() ? "true" : "false");
-			return os;
+				w.Raw(Bool() ? "true" : "false");
 		}
 		JValue* Clone() const override
 		{
@@ -435,7 +923,7 @@ namespace namespace_json_2 {
 			}
 			else if (o->type == VALUE_TYPE::STRING) {
 				auto S = static_cast<JString*>(o);
-				return this->to_string() == *static_cast<std::string*>(S);
+				return this->to_string() == std::string_view(*S);
 			}
 			else if (o->type != VALUE_TYPE::JLITERAL) {
 				return false;
@@ -446,6 +934,117 @@ namespace namespace_json_2 {
 		}
 
 		static JLiteral* Parse(std::istream& is);
+		static JLiteral* Parse(JBuffer& is);
+		template <typename Policy = DefaultPolicy, typename Reader>
+		static JLiteral* ParseWith(Reader& is, std::pmr::memory_resource* mr = nullptr);
+	};
+
+	//연속된 메모리 버퍼를 istream처럼 읽는 리더. 가상 호출 없이 포인터로만 이동
+	//index가 주어지면 공백과 문자열 구간을 비트맵으로 건너뜀
+	class JBuffer {
+		const char* const first;
+		const char* const last;
+		const char* cur;
+		bool end_reached;
+		const StructuralIndex* index;
+	public:
+		using char_type = char;
+
+		JBuffer(const char* data, size_t size, const StructuralIndex* index = nullptr) noexcept
+			: first(data), last(data + size), cur(data), end_reached(false), index(index) {}
+		JBuffer(std::string_view str, const StructuralIndex* index = nullptr) noexcept : JBuffer(str.data(), str.size(), index) {}
+		JBuffer(const JBuffer&) = delete;
+
+		int get() noexcept
+		{
+			if (cur == last) {
+				end_reached = true;
+				return EOF;
+			}
+			return static_cast<unsigned char>(*cur++);
+		}
+
+		bool get(char& c) noexcept
+		{
+			if (cur == last) {
+				end_reached = true;
+				return false;
+			}
+			c = *cur++;
+			return true;
+		}
+
+		int peek() const noexcept
+		{
+			return cur == last ? EOF : static_cast<unsigned char>(*cur);
+		}
+
+		void unget() noexcept
+		{
+			if (!end_reached && cur != first) //istream과 같이 끝에 도달한 뒤에는 되돌리지 않음
+				--cur;
+		}
+
+		bool read(char* s, size_t n) noexcept
+		{
+			if (static_cast<size_t>(last - cur) < n) {
+				cur = last;
+				end_reached = true;
+				return false;
+			}
+			memcpy(s, cur, n);
+			cur += n;
+			return true;
+		}
+
+		//std::getline(is, s, delim)과 같은 동작
+		void getline(std::string& s, char delim)
+		{
+			const char* found = static_cast<const char*>(memchr(cur, delim, last - cur));
+			if (found == nullptr) {
+				s.assign(cur, last);
+				cur = last;
+				end_reached = true;
+				return;
+			}
+			s.assign(cur, found);
+			cur = found + 1;
+		}
+
+		//공백을 건너뛰고 남은 문자가 있는지 반환
+		bool skip_spaces() noexcept
+		{
+			if (index != nullptr)
+				cur = first + index->NextNonSpace(cur - first);
+			else
+				while (cur != last && simd_detail::IsSpace(*cur))
+					++cur;
+
+			if (cur == last) {
+				end_reached = true;
+				return false;
+			}
+			return true;
+		}
+
+		//quot 또는 '\\' 직전까지의 길이
+		size_t plain_length(char quot) const noexcept
+		{
+			if (index != nullptr && quot == '"')
+				return first + index->NextSpecial(cur - first) - cur;
+
+			const char* p = cur;
+			while (p != last && *p != quot && *p != '\\')
+				++p;
+			return p - cur;
+		}
+
+		bool good() const noexcept { return !end_reached; }
+		bool eof() const noexcept { return end_reached; }
+		std::ptrdiff_t tellg() const noexcept { return cur - first; }
+		const char* data() const noexcept { return cur; }
+		void skip(size_t n) noexcept { cur += n; }
+		size_t remaining() const noexcept { return last - cur; }
 	};
 
 	std::runtime_error json_parse_error(const char* call, const char* what, int position) {
@@ -463,138 +1062,829 @@ namespace namespace_json_2 {
 	}
 #define JSONLIB_THROW_ERROR(what) json_parse_error(__FUNCTION__, what, is.tellg())
 
-	static void SkipSpaces(std::istream& is)
-	{
-		std::istream::char_type c;
-		while (is.get(c) && std::isspace(c));
-		if (!is.good())
-			throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
-		is.unget();
-	}
+	//로케일과 무관하고 할당 없는 숫자 변환
+	namespace number_detail {
+		struct Number {
+			JNumber::KIND kind = JNumber::KIND::INT;
+			union {
+				int64_t i = 0;
+				uint64_t u;
+				JFloat f;
+			};
+		};
 
-	static auto ReadSkipSpaces(std::istream& is)
-	{
-		std::istream::char_type c;
-		while (is.get(c) && std::isspace(c));
-		if (!is.good())
-			throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
-		return c;
-	}
+		//[+-]digits[.digits][(e|E)[+-]digits] 형식의 끝 위치 (문법 검사는 Convert에서)
+		inline const char* Scan(const char* p, const char* last) noexcept
+		{
+			auto digits = [&]() {
+				while (p != last && static_cast<unsigned>(*p - '0') < 10)
+					++p;
+			};
+			if (p != last && (*p == '-' || *p == '+'))
+				++p;
+			digits();
+			if (p != last && *p == '.') {
+				++p;
+				digits();
+			}
+			if (p != last && (*p == 'e' || *p == 'E')) {
+				++p;
+				if (p != last && (*p == '-' || *p == '+'))
+					++p;
+				digits();
+			}
+			return p;
+		}
+
+		//[bg, end)가 JSON 문법의 숫자인지: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+		//Convert는 앞의 '+', 앞의 0, 빈 소수부도 받으므로 StrictPolicy에서 따로 확인
+		inline bool IsStrict(const char* p, const char* end) noexcept
+		{
+			auto digits = [&]() {
+				const char* const s = p;
+				while (p != end && static_cast<unsigned>(*p - '0') < 10)
+					++p;
+				return p != s;
+			};
+			if (p != end && *p == '-')
+				++p;
+			if (p != end && *p == '0')
+				++p;
+			else if (!digits())
+				return false;
+			if (p != end && *p == '.') {
+				++p;
+				if (!digits())
+					return false;
+			}
+			if (p != end && (*p == 'e' || *p == 'E')) {
+				++p;
+				if (p != end && (*p == '-' || *p == '+'))
+					++p;
+				if (!digits())
+					return false;
+			}
+			return p == end;
+		}
+
+		//[bg, end) 전체를 숫자로 변환. 형식이 틀리면 false
+		//19자리 이하의 정수는 바로 누적하고, 실수는 가수가 2^53 이하이고 10의 지수가 22 이하일 때
+		//double 연산 한 번으로 정확히 계산 (Clinger). 나머지는 from_chars로 정확히 변환
+		inline bool Convert(const char* bg, const char* end, Number& out) noexcept
+		{
+			static constexpr JFloat pow10[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+			};
+
+			const char* p = bg;
+			bool neg = false;
+			if (p != end && (*p == '-' || *p == '+')) {
+				neg = *p == '-';
+				++p;
+			}
+			const char* const digits = p;
+
+			bool tiny = false; //범위를 넘을 때 0으로 (아니면 무한대)
+			uint64_t m = 0;
+			int nd = 0; //유효 자릿수 (앞의 0 제외)
+			int dropped = 0; //19자리를 넘어 버린 정수부 자릿수
+			for (; p != end && static_cast<unsigned>(*p - '0') < 10; ++p) {
+				if (nd < 19) {
+					m = m * 10 + (*p - '0');
+					if (m != 0)
+						nd++;
+				}
+				else {
+					dropped++;
+				}
+			}
+			if (p == digits)
+				return false;
+
+			if (p == end) { //정수
+				if (dropped == 0) {
+					if (!neg && m <= static_cast<uint64_t>(INT64_MAX)) {
+						out.kind = JNumber::KIND::INT;
+						out.i = static_cast<int64_t>(m);
+						return true;
+					}
+					if (neg && m <= uint64_t(1) << 63) {
+						out.kind = JNumber::KIND::INT;
+						out.i = static_cast<int64_t>(0 - m);
+						return true;
+					}
+					if (!neg) {
+						out.kind = JNumber::KIND::UINT;
+						out.u = m;
+						return true;
+					}
+				}
+				else if (!neg && dropped == 1) { //20자리는 uint64_t에 들어갈 수 있음
+					uint64_t u;
+					if (std::from_chars(digits, end, u).ec == std::errc()) {
+						out.kind = JNumber::KIND::UINT;
+						out.u = u;
+						return true;
+					}
+				}
+			}
+			else {
+				int exp10 = dropped;
+				bool exact = dropped == 0;
+				if (*p == '.') {
+					++p;
+					for (; p != end && static_cast<unsigned>(*p - '0') < 10; ++p) {
+						if (nd < 19) {
+							m = m * 10 + (*p - '0');
+							exp10--;
+							if (m != 0)
+								nd++;
+						}
+						else if (*p != '0') {
+							exact = false;
+						}
+					}
+				}
+				if (p != end && (*p == 'e' || *p == 'E')) {
+					++p;
+					bool eneg = false;
+					if (p != end && (*p == '-' || *p == '+')) {
+						eneg = *p == '-';
+						++p;
+					}
+					const char* const edigits = p;
+					int e = 0;
+					for (; p != end && static_cast<unsigned>(*p - '0') < 10; ++p) {
+						if (e < 100000)
+							e = e * 10 + (*p - '0');
+					}
+					if (p == edigits)
+						return false;
+					exp10 += eneg ? -e : e;
+				}
+				if (p != end)
+					return false;
+
+				tiny = exp10 < 0;
+				if (exact && m <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+					JFloat d = static_cast<JFloat>(m);
+					d = exp10 < 0 ? d / pow10[-exp10] : d * pow10[exp10];
+					out.kind = JNumber::KIND::FLOAT;
+					out.f = neg ? -d : d;
+					return true;
+				}
+			}
+
+			//느린 경로: 정확한 변환
+			out.kind = JNumber::KIND::FLOAT;
+			const char* const first = *bg == '+' ? bg + 1 : bg;
+			const auto r = std::from_chars(first, end, out.f);
+			if (r.ec == std::errc::result_out_of_range) {
+				out.f = tiny ? 0.0 : std::numeric_limits<JFloat>::infinity();
+				if (neg)
+					out.f = -out.f;
+				return true;
+			}
+			return r.ec == std::errc() && r.ptr == end;
+		}
+	}
+
+	static void ReadUntil(std::istream& is, std::string& s, char delim)
+	{
+		std::getline(is, s, delim);
+	}
+
+	static void ReadUntil(JBuffer& is, std::string& s, char delim)
+	{
+		is.getline(s, delim);
+	}
+
+	//istream은 구간을 미리 볼 수 없으므로 아무것도 하지 않고 호출자가 한 글자씩 읽음
+	template <typename Str>
+	static void AppendPlain(std::istream&, Str&, char) {}
+
+	//이스케이프나 따옴표가 나오기 전까지의 구간을 한 번에 복사
+	template <typename Str>
+	static void AppendPlain(JBuffer& is, Str& str, char quot)
+	{
+		const size_t n = is.plain_length(quot);
+		str.append(is.data(), n);
+		is.skip(n);
+	}
+
+	static void SkipSpaces(JBuffer& is)
+	{
+		if (!is.skip_spaces())
+			throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
+	}
+
+	static char ReadSkipSpaces(JBuffer& is)
+	{
+		if (!is.skip_spaces())
+			throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
+		return static_cast<char>(is.get());
+	}
+
+	template <typename Reader>
+	static void SkipSpaces(Reader& is)
+	{
+		char c;
+		while (is.get(c) && std::isspace(c));
+		if (!is.good())
+			throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
+		is.unget();
+	}
+
+	template <typename Reader>
+	static auto ReadSkipSpaces(Reader& is)
+	{
+		char c;
+		while (is.get(c) && std::isspace(c));
+		if (!is.good())
+			throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
+		return c;
+	}
+
+	//최상위 값 뒤에는 공백만 올 수 있음. Policy::validate일 때만 검사하고 나머지 정책은 뒤의 데이터를 읽지 않음
+	template <typename Policy, typename Reader>
+	static void ExpectEnd(Reader& is)
+	{
+		if constexpr (Policy::validate) {
+			int c;
+			while ((c = is.peek()) != EOF && std::isspace(c))
+				is.get();
+			if (c != EOF)
+				throw JSONLIB_THROW_ERROR("값 뒤에 다른 데이터가 있습니다");
+		}
+	}
 
 	JValue* JValue::Parse(std::istream& is)
 	{
-		JValue* v = nullptr;
+		return ParseWith(is);
+	}
+
+	JValue* JValue::Parse(JBuffer& is)
+	{
+		return ParseWith(is);
+	}
+
+	JValue* JValue::Parse(std::string_view str, const StructuralIndex* index)
+	{
+		return Parse(str.data(), str.size(), index);
+	}
+
+	JValue* JValue::Parse(const char* data, size_t size, const StructuralIndex* index)
+	{
+		JBuffer buf(data, size, index);
+		JValue* v = ParseWith(buf);
+		try {
+			ExpectEnd<DefaultPolicy>(buf);
+		}
+		catch (...) {
+			Release(v);
+			throw;
+		}
+		return v;
+	}
+
+	//SAX 방식 파서. 트리를 만들지 않고 Handler에 이벤트를 보냄
+	//Handler는 다음 함수를 가져야 함 (템플릿 인자이므로 상속이나 가상 함수는 필요 없음)
+	//	StartObject(), Key(std::string_view), EndObject(size_t 멤버 수)
+	//	StartArray(), EndArray(size_t 원소 수)
+	//	String(std::string_view), Number(int64_t), Number(uint64_t), Number(JFloat), Bool(bool), Null()
+	//	Number(uint64_t)는 int64_t 범위를 넘는 양의 정수일 때만 호출됨
+	//string_view 인자는 이벤트가 끝나면 무효가 됨
+	//Policy는 허용하는 문법과 검사 수준 (StrictPolicy, LenientPolicy, TrustedPolicy)
+	template <typename Reader, typename Handler, typename Policy = DefaultPolicy>
+	class JParser {
+		Reader& is;
+		Handler& handler;
+		std::string scratch; //문자열, 키, 숫자를 읽는 재사용 버퍼
+	public:
+		JParser(Reader& is, Handler& handler) : is(is), handler(handler) {}
+		JParser(const JParser&) = delete;
+
+		void ParseValue();
+		void ParseNumber();
+		void ParseString();
+		void ParseArray();
+		void ParseObject();
+		void ParseLiteral();
+	};
+
+	template <typename Reader, typename Handler, typename Policy>
+	void JParser<Reader, Handler, Policy>::ParseValue()
+	{
 		auto c = ReadSkipSpaces(is); is.unget();
 
 		switch (c) {
 			//string
 		case '"':
+			ParseString();
+			break;
 		case '\'':
-			v = JString::Parse(is);
+			if constexpr (!Policy::single_quotes)
+				throw JSONLIB_THROW_ERROR("작은따옴표 문자열은 허용되지 않습니다");
+			ParseString();
 			break;
 			//number with sign 
 		case '-':
 		case '+':
-			v = JNumber::Parse(is);
+			ParseNumber();
 			break;
 			//array
 		case '[':
-			v = JArray::Parse(is);
+			ParseArray();
 			break;
 			//object
 		case '{':
-			v = JObject::Parse(is);
+			ParseObject();
 			break;
 		default: //else: number, symbolic literal, error
 		{
 			if (std::isdigit(c)) { //number
-				v = JNumber::Parse(is);
+				ParseNumber();
 			}
 			else if (std::isalpha(c)) { //symbolic literal
-				v = JLiteral::Parse(is);
+				ParseLiteral();
 			}
 			else {
 				throw JSONLIB_THROW_ERROR("인식 불가");
 			}
 		}
 		}
-
-		return v;
 	}
 
-	JNumber* JNumber::Parse(std::istream& is)
+	template <typename Reader, typename Handler, typename Policy>
+	void JParser<Reader, Handler, Policy>::ParseNumber()
 	{
-		std::string buf;
-		std::istream::char_type c = is.get();
-		
-#ifdef PARSE_STRICT_CHECK
-		if (!(c == '+' || c == '-' || isdigit(c))) //strict check
-			throw JSONLIB_THROW_ERROR("숫자 형식 오류");
-#endif
-		buf += c; //+,- sign 처리
-		while (c = is.get(), isdigit(c)) {
-			buf += c;
+		const char* bg;
+		const char* end;
+		if constexpr (std::is_same_v<Reader, JBuffer>) { //원문에서 바로 변환
+			bg = is.data();
+			end = number_detail::Scan(bg, bg + is.remaining());
+			is.skip(end - bg);
 		}
+		else {
+			std::string& buf = scratch;
+			buf.clear();
+			char c = is.get();
 
-		bool isFloating = false;
-		if (c == '.') {
-			isFloating = true;
-			buf += c;
+			if constexpr (Policy::validate) {
+				if (!(c == '+' || c == '-' || isdigit(c))) //strict check
+					throw JSONLIB_THROW_ERROR("숫자 형식 오류");
+			}
+			buf += c; //+,- sign 처리
 			while (c = is.get(), isdigit(c)) {
 				buf += c;
 			}
+
+			if (c == '.') {
+				buf += c;
+				while (c = is.get(), isdigit(c)) {
+					buf += c;
+				}
+			}
+
+			if (c == 'e' || c == 'E') {
+				buf += c;
+				c = is.get();
+				if constexpr (Policy::validate) {
+					if (!(c == '+' || c == '-' || isdigit(c))) //strict check
+						throw JSONLIB_THROW_ERROR("숫자 형식 오류");
+				}
+				buf += c; //+, - sign 처리
+				while (c = is.get(), isdigit(c)) {
+					buf += c;
+				}
+			}
+			is.unget(); //숫자 표현식 뒤의 문자
+
+			bg = buf.data();
+			end = buf.data() + buf.size();
 		}
 
-		if (c == 'e' || c == 'E') {
-			isFloating = true;
-			buf += c;
-			c = is.get();
-#ifdef PARSE_STRICT_CHECK
-			if (!(c == '+' || c == '-' || isdigit(c))) //strict check
+		if constexpr (Policy::validate) {
+			if (!number_detail::IsStrict(bg, end))
 				throw JSONLIB_THROW_ERROR("숫자 형식 오류");
-#endif
-			buf += c; //+, - sign 처리
-			while (c = is.get(), isdigit(c)) {
-				buf += c;
+		}
+
+		number_detail::Number n;
+		if (!number_detail::Convert(bg, end, n))
+			throw JSONLIB_THROW_ERROR("숫자 형식 오류");
+
+		switch (n.kind) {
+		case JNumber::KIND::INT:
+			handler.Number(n.i);
+			break;
+		case JNumber::KIND::UINT:
+			handler.Number(n.u);
+			break;
+		default:
+			handler.Number(n.f);
+		}
+	}
+
+	template <typename Reader, typename Handler, typename Policy>
+	void JParser<Reader, Handler, Policy>::ParseString()
+	{
+		scratch.clear();
+		JString::ParseStringInto<Policy>(is, scratch);
+		handler.String(std::string_view(scratch));
+	}
+
+	template <typename Reader, typename Handler, typename Policy>
+	void JParser<Reader, Handler, Policy>::ParseArray()
+	{
+		if constexpr (Policy::optional_brackets) {
+			if (is.get() != '[') //파싱 전 배열 시작 제거
+				is.unget();
+		}
+		else if constexpr (Policy::validate) {
+			if (is.get() != '[')
+				throw JSONLIB_THROW_ERROR("배열은 '['로 시작해야 합니다");
+		}
+		else {
+			is.get();
+		}
+		handler.StartArray();
+
+		size_t count = 0;
+		if (ReadSkipSpaces(is) == ']') { //빈 배열
+			handler.EndArray(count);
+			return;
+		}
+		is.unget();
+
+		while (is.good())
+		{
+			SkipSpaces(is);
+			ParseValue();
+			count++;
+
+			if (is.good())
+			{
+				auto c = ReadSkipSpaces(is);
+				if (c == ']')
+				{
+					handler.EndArray(count);
+					return;
+				}
+				else if (c != ',') {
+					throw JSONLIB_THROW_ERROR("불완전한 배열");
+				}
 			}
 		}
-		is.unget(); //숫자 표현식 뒤의 문자
 
-		if (isFloating) {
-			JFloat d = std::atof(buf.c_str());
-			return new JNumber(d);
+		throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
+	}
+
+	template <typename Reader, typename Handler, typename Policy>
+	void JParser<Reader, Handler, Policy>::ParseObject()
+	{
+		if constexpr (Policy::optional_brackets) {
+			if (is.get() != '{') //파싱 전 객체 시작 제거
+				is.unget();
+		}
+		else if constexpr (Policy::validate) {
+			if (is.get() != '{')
+				throw JSONLIB_THROW_ERROR("객체는 '{'로 시작해야 합니다");
 		}
 		else {
-			int i = std::atoi(buf.c_str());
-			return new JNumber(i);
+			is.get();
+		}
+		handler.StartObject();
+
+		size_t count = 0;
+		if (ReadSkipSpaces(is) == '}') { //빈 객체
+			handler.EndObject(count);
+			return;
+		}
+		is.unget();
+
+		while (is.good())
+		{
+			SkipSpaces(is);
+			scratch.clear();
+			if constexpr (Policy::unquoted_keys) {
+				auto bg = is.peek();
+				if (bg == '\'' || bg == '"') {
+					JString::ParseStringInto<Policy>(is, scratch);
+					if (ReadSkipSpaces(is) != ':')
+						throw JSONLIB_THROW_ERROR("':' 없음");
+				}
+				else {
+					ReadUntil(is, scratch, ':');
+					if (is.eof())
+						throw JSONLIB_THROW_ERROR("':' 없음");
+				}
+			}
+			else {
+				JString::ParseStringInto<Policy>(is, scratch);
+				if constexpr (Policy::trust_input)
+					ReadSkipSpaces(is);
+				else if (ReadSkipSpaces(is) != ':')
+					throw JSONLIB_THROW_ERROR("':' 없음");
+			}
+			handler.Key(std::string_view(scratch));
+
+			SkipSpaces(is);
+			ParseValue();
+			count++;
+
+			if (is.good())
+			{
+				auto c = ReadSkipSpaces(is);
+				if (c == '}') {
+					handler.EndObject(count);
+					return;
+				}
+				else if (c != ',') {
+					throw JSONLIB_THROW_ERROR("콤마 없이 다음 값을 읽을 수 없습니다");
+				}
+			}
+		}
+
+		throw JSONLIB_THROW_ERROR("[JObject::Parse] 비정상적 스트림 종료");
+	}
+
+	template <typename Reader, typename Handler, typename Policy>
+	void JParser<Reader, Handler, Policy>::ParseLiteral()
+	{
+		std::string_view cu; //current checking token
+		if (!is.good())
+			throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
+
+		const int first = is.get();
+		if constexpr (Policy::trust_input) { //철자는 확인하지 않고 길이만큼 건너뜀
+			const int rest = first == 'f' ? 4 : 3;
+			for (int i = 0; i < rest; i++)
+				is.get();
+			if (first == 'n')
+				handler.Null();
+			else
+				handler.Bool(first == 't');
+			return;
+		}
+
+		switch (first) {
+		case 't':
+			cu = "true";
+			break;
+		case 'f':
+			cu = "false";
+			break;
+		case 'n':
+			cu = "null";
+			break;
+		default:
+			throw JSONLIB_THROW_ERROR("정의되지 않은 토큰");
+		}
+
+		char c;
+		size_t idx = 1;
+		while (is.get(c) && isalpha(c)) {
+			if (idx >= cu.length() || cu[idx++] != c) { //symbol이 모두 다르기 때문에
+				throw JSONLIB_THROW_ERROR("매칭되는 리터럴 없음");
+			}
+		}
+
+		if (idx != cu.length()) {
+			throw JSONLIB_THROW_ERROR("매칭되는 리터럴 없음");
+		}
+
+		is.unget(); //리터럴 뒤에 붙은 문자
+
+		if (first == 'n')
+			handler.Null();
+		else
+			handler.Bool(first == 't');
+	}
+
+	template <typename Policy = DefaultPolicy, typename Handler>
+	void ParseSAX(std::istream& is, Handler& handler)
+	{
+		JParser<std::istream, Handler, Policy>(is, handler).ParseValue();
+		ExpectEnd<Policy>(is);
+	}
+
+	template <typename Policy = DefaultPolicy, typename Handler>
+	void ParseSAX(std::string_view str, Handler& handler, const StructuralIndex* index = nullptr)
+	{
+		JBuffer is(str, index);
+		JParser<JBuffer, Handler, Policy>(is, handler).ParseValue();
+		ExpectEnd<Policy>(is);
+	}
+
+	//SAX 이벤트로 JValue 트리를 만드는 핸들러. mr이 주어지면 노드를 arena에 생성
+	//keys가 주어지면 객체 키를 KeyPool에 등록하고 복사하지 않음
+	class JDomBuilder {
+		std::pmr::memory_resource* mr;
+		KeyPool* keys;
+		JValue* root = nullptr;
+		std::vector<JValue*> stack; //열려 있는 배열/객체
+		std::string key;
+		std::string_view interned;
+
+		void Add(JValue* v)
+		{
+			if (stack.empty()) {
+				root = v;
+				return;
+			}
+
+			JValue* top = stack.back();
+			if (top->type == VALUE_TYPE::ARRAY)
+				static_cast<JArray*>(top)->push_back(v);
+			else if (keys != nullptr)
+				static_cast<JObject*>(top)->Set(JKey::Interned(interned), v);
+			else
+				static_cast<JObject*>(top)->Set(key, v);
+		}
+	public:
+		explicit JDomBuilder(std::pmr::memory_resource* mr = nullptr, KeyPool* keys = nullptr) : mr(mr), keys(keys) {}
+		JDomBuilder(const JDomBuilder&) = delete;
+		~JDomBuilder()
+		{
+			JValue::Release(root); //파싱 도중 예외가 나면 만들던 트리를 해제
+		}
+
+		//완성된 값을 넘겨받음. 이후 빌더는 다음 값을 만들 수 있음
+		JValue* Take() noexcept
+		{
+			JValue* v = root;
+			root = nullptr;
+			stack.clear();
+			return v;
+		}
+
+		void StartObject()
+		{
+			auto o = JValue::Create<JObject>(mr, mr);
+			Add(o);
+			stack.push_back(o);
+		}
+
+		void Key(std::string_view k)
+		{
+			if (keys != nullptr)
+				interned = keys->Intern(k);
+			else
+				key.assign(k.data(), k.size());
+		}
+
+		void EndObject(size_t)
+		{
+			stack.pop_back();
+		}
+
+		void StartArray()
+		{
+			auto a = JValue::Create<JArray>(mr, mr);
+			Add(a);
+			stack.push_back(a);
+		}
+
+		void EndArray(size_t)
+		{
+			stack.pop_back();
+		}
+
+		void String(std::string_view s)
+		{
+			Add(JValue::Create<JString>(mr, s, mr));
 		}
+
+		void Number(int64_t i)
+		{
+			Add(JValue::Create<JNumber>(mr, i));
+		}
+
+		void Number(uint64_t u)
+		{
+			Add(JValue::Create<JNumber>(mr, u));
+		}
+
+		void Number(JFloat d)
+		{
+			Add(JValue::Create<JNumber>(mr, d));
+		}
+
+		void Bool(bool b)
+		{
+			Add(JValue::Create<JLiteral>(mr, b));
+		}
+
+		void Null()
+		{
+			Add(JValue::Create<JLiteral>(mr));
+		}
+	};
+
+	template <typename Policy, typename Reader>
+	JValue* JValue::ParseWith(Reader& is, std::pmr::memory_resource* mr, KeyPool* keys)
+	{
+		JDomBuilder builder(mr, keys);
+		JParser<Reader, JDomBuilder, Policy>(is, builder).ParseValue();
+		return builder.Take();
+	}
+
+	JNumber* JNumber::Parse(std::istream& is)
+	{
+		return ParseWith(is);
+	}
+
+	JNumber* JNumber::Parse(JBuffer& is)
+	{
+		return ParseWith(is);
+	}
+
+	template <typename Policy, typename Reader>
+	JNumber* JNumber::ParseWith(Reader& is, std::pmr::memory_resource* mr)
+	{
+		JDomBuilder builder(mr);
+		JParser<Reader, JDomBuilder, Policy>(is, builder).ParseNumber();
+		return static_cast<JNumber*>(builder.Take());
 	}
 
 	JString* JString::Parse(std::istream& is)
 	{
-		const std::string& str = ParseString(is);
-		return new JString(str);
+		return ParseWith(is);
+	}
+
+	JString* JString::Parse(JBuffer& is)
+	{
+		return ParseWith(is);
+	}
+
+	template <typename Policy, typename Reader>
+	JString* JString::ParseWith(Reader& is, std::pmr::memory_resource* mr)
+	{
+		auto str = Create<JString>(mr, mr);
+		try {
+			ParseStringInto<Policy>(is, *str);
+		}
+		catch (std::exception&)
+		{
+			Release(str);
+			throw;
+		}
+		return str;
 	}
 
 	std::string JString::ParseString(std::istream& is)
+	{
+		std::string str;
+		ParseStringInto(is, str);
+		return str;
+	}
+
+	std::string JString::ParseString(JBuffer& is)
+	{
+		std::string str;
+		ParseStringInto(is, str);
+		return str;
+	}
+
+	template <typename Policy, typename Reader, typename Str>
+	void JString::ParseStringInto(Reader& is, Str& str)
 	{
 		constexpr char escaper = '\\';
-		std::istream::char_type c, quot = is.get();
-#ifdef PARSE_STRICT_CHECK
-		if (quot != '"' && quot != '\'')
-			throw JSONLIB_THROW_ERROR("문자열은 반드시 '또는 \"로 시작해야 합니다");
-#endif
+		char c, quot = is.get();
+		if constexpr (Policy::validate) {
+			if (quot != '"' && (!Policy::single_quotes || quot != '\''))
+				throw JSONLIB_THROW_ERROR("문자열은 반드시 \"로 시작해야 합니다");
+		}
 		bool escaping = false;
 
-		std::string str;
-		while (is.get(c))
+		while (true)
 		{
+			if (!escaping) {
+				const size_t from = str.size();
+				AppendPlain(is, str, quot);
+				if constexpr (Policy::validate) {
+					for (size_t i = from; i < str.size(); i++) {
+						if (static_cast<unsigned char>(str[i]) < 0x20)
+							throw JSONLIB_THROW_ERROR("문자열에 제어 문자가 있습니다");
+					}
+				}
+			}
+			if (!is.get(c))
+				break;
+
 			if (escaping)
 			{
 				if (c == 'u') {
 					char hex[5] = { 0 };
 					if (!is.read(hex, 4))
 						throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
+					if constexpr (Policy::validate) {
+						for (int i = 0; i < 4; i++) {
+							if (!isxdigit(static_cast<unsigned char>(hex[i])))
+								throw JSONLIB_THROW_ERROR("\\u 뒤에는 16진수 4자리가 와야 합니다");
+						}
+					}
 
 					wchar_t wc = ::strtol(hex, NULL, 16);
 					char buff[5] = { 0 };
@@ -618,6 +1908,15 @@ namespace namespace_json_2 {
 					case 't':
 						c = '\t';
 						break;
+					case '"':
+					case '\\':
+					case '/':
+						break;
+					default:
+						if constexpr (Policy::validate) {
+							if (c != quot)
+								throw JSONLIB_THROW_ERROR("잘못된 이스케이프");
+						}
 					}
 					str.push_back(c);
 				}
@@ -625,11 +1924,16 @@ namespace namespace_json_2 {
 				continue;
 			}
 			else if (c == quot)
-				return str;
+				return;
 			else if (c == escaper)
 				escaping = true;
-			else
+			else {
+				if constexpr (Policy::validate) {
+					if (static_cast<unsigned char>(c) < 0x20)
+						throw JSONLIB_THROW_ERROR("문자열에 제어 문자가 있습니다");
+				}
 				str.push_back(c);
+			}
 		}
 
 		//quot 나오기 전에 스트림 종료->오류
@@ -638,200 +1942,115 @@ namespace namespace_json_2 {
 
 	JArray* JArray::Parse(std::istream& is)
 	{
-		auto arr = new JArray();
-
-#ifdef PARSE_STRICT_CHECK
-		if (is.get() != '[')
-			throw JSONLIB_THROW_ERROR("배열은 '['로 시작해야 합니다");
-#else
-		if (is.get() != '[') //파싱 전 배열 시작 제거
-			is.unget();
-#endif
-
-		std::istream::char_type c;
-		while (is.good())
-		{
-			JValue* v = nullptr;
-			SkipSpaces(is);
-			try {
-				v = JValue::Parse(is);
-				arr->push_back(v);
-			}
-			catch (std::exception& e)
-			{
-				if (v)
-					delete v;
-
-				delete arr;
-				throw e;
-			}
+		return ParseWith(is);
+	}
 
-			if (is.good())
-			{
-				c = ReadSkipSpaces(is);
-				if (c == ']')
-				{
-					break;
-				}
-				else if (c != ',') {
-					delete arr;
-					throw JSONLIB_THROW_ERROR("불완전한 배열");
-				}
-			}
-			else {
-				delete arr;
-				throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
-			}
-		}
+	JArray* JArray::Parse(JBuffer& is)
+	{
+		return ParseWith(is);
+	}
 
-		return arr;
+	template <typename Policy, typename Reader>
+	JArray* JArray::ParseWith(Reader& is, std::pmr::memory_resource* mr)
+	{
+		JDomBuilder builder(mr);
+		JParser<Reader, JDomBuilder, Policy>(is, builder).ParseArray();
+		return static_cast<JArray*>(builder.Take());
 	}
 
 	JObject* JObject::Parse(std::istream& is)
 	{
-		auto obj = new JObject();
+		return ParseWith(is);
+	}
 
-#ifdef PARSE_STRICT_CHECK
-		if (is.get() != '{')
-			throw JSONLIB_THROW_ERROR("객체는 '{'로 시작해야 합니다");
-#else
-		if (is.get() != '{') //파싱 전 객체 시작 제거
-			is.unget();
-#endif
+	JObject* JObject::Parse(JBuffer& is)
+	{
+		return ParseWith(is);
+	}
 
-		
-		while (is.good())
-		{
-			JValue* v = nullptr;
-			SkipSpaces(is);
-			try {
-				std::string key;
-				auto bg = is.peek();
-				if (bg == '\'' || bg == '"') {
-					key = JString::ParseString(is);
-					if (ReadSkipSpaces(is) != ':')
-						throw JSONLIB_THROW_ERROR("':' 없음");
-				}
-				else {
-					std::getline(is, key, ':');
-					if (is.eof())
-						throw JSONLIB_THROW_ERROR("':' 없음");
-				}
-				
-				SkipSpaces(is);
-				v = JValue::Parse(is);
-				obj->Set(key, v);
-			}
-			catch (std::exception& e)
-			{
-				if (v)
-					delete v;
+	template <typename Policy, typename Reader>
+	JObject* JObject::ParseWith(Reader& is, std::pmr::memory_resource* mr)
+	{
+		JDomBuilder builder(mr);
+		JParser<Reader, JDomBuilder, Policy>(is, builder).ParseObject();
+		return static_cast<JObject*>(builder.Take());
+	}
 
-				delete obj;
-				throw e;
-			}
+	JLiteral* JLiteral::Parse(std::istream& is)
+	{
+		return ParseWith(is);
+	}
 
-			if (is.good())
-			{
-				auto c = ReadSkipSpaces(is);
-				if (c == '}')
-					break;
-				else if (c != ',') {
-					delete obj;
-					throw JSONLIB_THROW_ERROR("콤마 없이 다음 값을 읽을 수 없습니다");
-				}
-			}
-			else {
-				delete obj;
-				throw JSONLIB_THROW_ERROR("[JObject::Parse] 비정상적 스트림 종료");
-			}
-		}
-		return obj;
+	JLiteral* JLiteral::Parse(JBuffer& is)
+	{
+		return ParseWith(is);
 	}
 
-	JLiteral* JLiteral::Parse(std::istream& is)
+	template <typename Policy, typename Reader>
+	JLiteral* JLiteral::ParseWith(Reader& is, std::pmr::memory_resource* mr)
 	{
-		const std::string str_true = "true", str_false = "false", str_null = "null";
-		const std::string* cu; //current checking token
-		JLiteral* ret = nullptr;
-		if (is.good())
+		JDomBuilder builder(mr);
+		JParser<Reader, JDomBuilder, Policy>(is, builder).ParseLiteral();
+		return static_cast<JLiteral*>(builder.Take());
+	}
+
+	//파싱한 문서 전체를 하나의 arena에 담는 소유자
+	//노드, 배열/객체의 저장 공간, 문자열이 모두 arena에서 할당되고 소멸 시 트리 순회 없이 한 번에 반환됨
+	//트리에 값을 추가하거나 교체할 때는 New* 함수로 만든 노드를 사용해야 함 (힙 노드는 회수되지 않음)
+	class Document {
+		std::pmr::monotonic_buffer_resource arena;
+		std::shared_ptr<KeyPool> keys; //여러 문서가 키를 공유할 때. 문서가 살아 있는 동안 풀도 유지됨
+		JValue* root = nullptr;
+	public:
+		explicit Document(size_t initial_size = 64 * 1024) : arena(initial_size) {}
+		explicit Document(std::shared_ptr<KeyPool> keys, size_t initial_size = 64 * 1024) : arena(initial_size), keys(std::move(keys)) {}
+		Document(const Document&) = delete;
+		Document& operator=(const Document&) = delete;
+
+		//이전 루트의 메모리는 Clear 전까지 arena에 남음
+		template <typename Policy = DefaultPolicy>
+		JValue* Parse(std::string_view str, const StructuralIndex* index = nullptr)
 		{
-			switch (is.get()) {
-			case 't':
-				cu = &str_true;
-				ret = new JLiteral(true);
-				break;
-			case 'f':
-				cu = &str_false;
-				ret = new JLiteral(false);
-				break;
-			case 'n':
-				cu = &str_null;
-				ret = new JLiteral();
-				break;
-			default:
-				throw JSONLIB_THROW_ERROR("정의되지 않은 토큰");
-			}
-		}
-		else {
-			throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
+			JBuffer buf(str, index);
+			JValue* v = JValue::ParseWith<Policy>(buf, &arena, keys.get());
+			ExpectEnd<Policy>(buf); //실패해도 노드는 arena에 있으므로 Clear 때 반환됨
+			return root = v;
 		}
 
-		std::istream::char_type c;
-		size_t c_length = cu->length(), idx = 1;
-		while (is.get(c) && isalpha(c)) {
-			if (idx >= c_length || (*cu)[idx++] != c) { //symbol이 모두 다르기 때문에
-				delete ret;
-				throw JSONLIB_THROW_ERROR("매칭되는 리터럴 없음");
-			}
+		template <typename Policy = DefaultPolicy>
+		JValue* Parse(std::istream& is)
+		{
+			JValue* v = JValue::ParseWith<Policy>(is, &arena, keys.get());
+			ExpectEnd<Policy>(is);
+			return root = v;
 		}
 
-		if (idx != c_length) {
-			delete ret;
-			throw JSONLIB_THROW_ERROR("매칭되는 리터럴 없음");
+		JValue* Root() const noexcept { return root; }
+		std::pmr::memory_resource* Resource() noexcept { return &arena; }
+
+		void Clear() noexcept
+		{
+			root = nullptr;
+			arena.release();
 		}
 
-		is.unget(); //리터럴 뒤에 붙은 문자
+		template <typename T, typename... Args>
+		T* New(Args&&... args)
+		{
+			return JValue::Create<T>(&arena, std::forward<Args>(args)...);
+		}
 
-		return ret;
-	}
+		JArray* NewArray() { return New<JArray>(&arena); }
+		JObject* NewObject() { return New<JObject>(&arena); }
+		JString* NewString(std::string_view str) { return New<JString>(str, &arena); }
+	};
 
-	static std::string EscapeString(const std::string& s)
+	static std::string EscapeString(std::string_view s)
 	{
-		std::ostringstream oss;
-		oss << '"';
-		for (const auto& c : s) {
-			switch (c) {
-			case '"':
-				oss << "\\\"";
-				break;
-			case '\\':
-				oss << "\\\\";
-				break;
-			case '/':
-				oss << "\\/";
-				break;
-			case '\b':
-				oss << "\\b";
-				break;
-			case '\f':
-				oss << "\\f";
-				break;
-			case '\n':
-				oss << "\\n";
-				break;
-			case '\r':
-				oss << "\\r";
-				break;
-			case '\t':
-				oss << "\\t";
-				break;
-			default:
-				oss << c;
-			}
-		}
-		oss << '"';
-		return oss.str();
+		std::string out;
+		out.reserve(s.size() + 2);
+		JWriter(out).String(s);
+		return out;
 	}
 
 	static std::vector<std::string> tokenize_selector(const std::string& select, char delim) {
@@ -847,6 +2066,7 @@ namespace namespace_json_2 {
 				os.clear();
 			}
 			else if (a == '\'' || a == '"') {
+				str.unget(); //ParseString이 따옴표부터 읽음
 				os << JString::ParseString(str);
 			}
 			else {
@@ -858,42 +2078,228 @@ namespace namespace_json_2 {
 		return token;
 	}
 
-	JValue* find(JValue* org, const std::string& select, char delim = '.') {
-		std::vector<std::string> path = tokenize_selector(select, delim);
-		
-		for (const auto& p : path) {
-			if (org->type == VALUE_TYPE::OBJECT)
-				org = static_cast<JObject*>(org)->at(p);
-			else if (org->type == VALUE_TYPE::ARRAY) {
-				size_t idx = std::stoi(p);
-				org = static_cast<JArray*>(org)->at(idx);
+	//한 번 해석해 두고 반복해서 쓰는 선택자. 키의 해시와 배열 인덱스를 미리 계산하므로 평가할 때 할당하지 않음
+	class CompiledPath {
+	public:
+		struct Step {
+			std::string key;
+			uint32_t hash; //JObject::Hash(key)
+			size_t index; //숫자가 아니면 npos
+		};
+		static constexpr size_t npos = static_cast<size_t>(-1);
+	private:
+		std::vector<Step> steps;
+		char delim;
+	public:
+		explicit CompiledPath(const std::string& select, char delim = '.') : delim(delim)
+		{
+			for (auto& token : tokenize_selector(select, delim)) {
+				size_t index = npos;
+				const char* const last = token.data() + token.size();
+				auto r = std::from_chars(token.data(), last, index);
+				if (r.ec != std::errc() || r.ptr != last)
+					index = npos;
+
+				const uint32_t hash = JObject::Hash(token);
+				steps.push_back(Step{ std::move(token), hash, index });
 			}
-			else {
-				break;
+		}
+
+		const std::vector<Step>& Steps() const noexcept { return steps; }
+		char Delimiter() const noexcept { return delim; }
+
+		//find()와 같음. 없는 키나 범위를 벗어난 인덱스는 std::out_of_range, 숫자가 아닌 인덱스는 std::invalid_argument
+		JValue* Find(JValue* org) const
+		{
+			for (const auto& step : steps) {
+				if (org->type == VALUE_TYPE::OBJECT) {
+					auto o = static_cast<JObject*>(org);
+					auto it = o->find(step.key, step.hash);
+					if (it == o->end())
+						throw std::out_of_range("키가 없습니다");
+					org = it->second;
+				}
+				else if (org->type == VALUE_TYPE::ARRAY) {
+					if (step.index == npos)
+						throw std::invalid_argument("배열 인덱스가 숫자가 아닙니다");
+					org = static_cast<JArray*>(org)->at(step.index);
+				}
+				else {
+					break;
+				}
 			}
+			return org;
 		}
 
-		return org;
-	}
+		//modify()와 같음
+		bool Modify(JValue* root, JValue* new_val) const
+		{
+			JValue** org = &root;
+			for (const auto& step : steps) {
+				if ((*org)->type == VALUE_TYPE::OBJECT) {
+					auto o = static_cast<JObject*>(*org);
+					auto it = o->find(step.key, step.hash);
+					if (it == o->end())
+						throw std::out_of_range("키가 없습니다");
+					org = &it->second;
+				}
+				else if ((*org)->type == VALUE_TYPE::ARRAY) {
+					if (step.index == npos)
+						throw std::invalid_argument("배열 인덱스가 숫자가 아닙니다");
+					org = &static_cast<JArray*>(*org)->at(step.index);
+				}
+				else {
+					return false;
+				}
+			}
 
-	bool modify(JValue* root, const std::string& select, JValue* new_val, char delim = '.') {
-		std::vector<std::string> path = tokenize_selector(select, delim);
+			JValue::Release(*org);
+			*org = new_val;
+			return true;
+		}
+
+		//선택자 문자열로 찾는 프로세스 전역 캐시. 여러 스레드에서 불러도 안전함
+		//가득 차면 비우고 다시 채움 (이미 받은 shared_ptr은 계속 유효)
+		static std::shared_ptr<const CompiledPath> Cached(const std::string& select, char delim = '.')
+		{
+			static constexpr size_t cache_limit = 1024;
+			static std::shared_mutex lock;
+			static std::unordered_map<std::string, std::shared_ptr<const CompiledPath>> cache;
+
+			{
+				std::shared_lock<std::shared_mutex> lk(lock);
+				auto it = cache.find(select);
+				if (it != cache.end() && it->second->delim == delim)
+					return it->second;
+			}
+
+			auto path = std::make_shared<const CompiledPath>(select, delim);
+			std::unique_lock<std::shared_mutex> lk(lock);
+			if (cache.size() >= cache_limit)
+				cache.clear();
+			cache[select] = path;
+			return path;
+		}
+	};
+
+	//여러 선택자를 공통 접두사끼리 묶은 트리. 문서를 한 번만 훑어서 모든 경로를 찾음
+	class PathSet {
+	public:
+		struct Node {
+			std::string key; //부모에서 이 노드로 오는 단계
+			uint32_t hash;
+			size_t index;
+			std::vector<size_t> children; //Nodes()의 위치
+			std::vector<size_t> targets; //여기서 끝나는 선택자 번호
+		};
+	private:
+		std::vector<Node> nodes; //nodes[0]은 루트
+		size_t count = 0;
 
-		JValue** org = &root;
-		for (const auto& p : path) {
-			if ((*org)->type == VALUE_TYPE::OBJECT)
-				org = &static_cast<JObject*>(*org)->at(p);
-			else if ((*org)->type == VALUE_TYPE::ARRAY) {
-				size_t idx = std::stoi(p);
-				org = &static_cast<JArray*>(*org)->at(idx);
+		void Add(const CompiledPath& path)
+		{
+			size_t n = 0;
+			for (const auto& step : path.Steps()) {
+				size_t next = 0;
+				for (size_t c : nodes[n].children) {
+					if (nodes[c].key == step.key) {
+						next = c;
+						break;
+					}
+				}
+				if (next == 0) {
+					next = nodes.size();
+					nodes.push_back(Node{ step.key, step.hash, step.index, {}, {} });
+					nodes[n].children.push_back(next);
+				}
+				n = next;
+			}
+			nodes[n].targets.push_back(count++);
+		}
+
+		void Fill(size_t n, JValue* v, JValue** out) const
+		{
+			for (size_t t : nodes[n].targets)
+				out[t] = v;
+			for (size_t c : nodes[n].children)
+				Fill(c, v, out);
+		}
+
+		void Visit(size_t n, JValue* v, JValue** out) const
+		{
+			const Node& node = nodes[n];
+			for (size_t t : node.targets)
+				out[t] = v;
+
+			if (v->type == VALUE_TYPE::OBJECT) {
+				auto o = static_cast<JObject*>(v);
+				for (size_t c : node.children) {
+					auto it = o->find(nodes[c].key, nodes[c].hash);
+					if (it != o->end())
+						Visit(c, it->second, out);
+				}
+			}
+			else if (v->type == VALUE_TYPE::ARRAY) {
+				auto a = static_cast<JArray*>(v);
+				for (size_t c : node.children) {
+					if (nodes[c].index < a->size())
+						Visit(c, (*a)[nodes[c].index], out);
+				}
 			}
 			else {
-				return false;
+				for (size_t c : node.children) //find()처럼 스칼라 값에서 멈춤
+					Fill(c, v, out);
 			}
 		}
+	public:
+		template <typename It>
+		PathSet(It first, It last, char delim = '.') : nodes(1)
+		{
+			for (; first != last; ++first)
+				Add(CompiledPath(*first, delim));
+		}
+
+		explicit PathSet(std::initializer_list<std::string> selects, char delim = '.')
+			: PathSet(selects.begin(), selects.end(), delim) {}
+
+		explicit PathSet(const std::vector<std::string>& selects, char delim = '.')
+			: PathSet(selects.begin(), selects.end(), delim) {}
+
+		size_t size() const noexcept { return count; }
+		const std::vector<Node>& Nodes() const noexcept { return nodes; }
+
+		//out[i]는 i번째 선택자의 값, 경로가 없으면 nullptr. out은 size()개 이상이어야 함
+		void Find(JValue* root, JValue** out) const
+		{
+			std::fill(out, out + count, nullptr);
+			Visit(0, root, out);
+		}
+
+		std::vector<JValue*> Find(JValue* root) const
+		{
+			std::vector<JValue*> out(count);
+			Find(root, out.data());
+			return out;
+		}
+	};
+
+	JValue* find(JValue* org, const std::string& select, char delim = '.') {
+		return CompiledPath::Cached(select, delim)->Find(org);
+	}
+
+	JValue* find(JValue* org, const CompiledPath& path) {
+		return path.Find(org);
+	}
+
+	std::vector<JValue*> find(JValue* org, const PathSet& paths) {
+		return paths.Find(org);
+	}
+
+	bool modify(JValue* root, const std::string& select, JValue* new_val, char delim = '.') {
+		return CompiledPath::Cached(select, delim)->Modify(root, new_val);
+	}
 
-		delete *org;
-		*org = new_val;
-		return true;
+	bool modify(JValue* root, const CompiledPath& path, JValue* new_val) {
+		return path.Modify(root, new_val);
 	}
 }
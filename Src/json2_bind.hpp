@@ -0,0 +1,373 @@
+#pragma once
+#include "json2.hpp"
+#include <map>
+#include <optional>
+
+namespace namespace_json_2 {
+	//JSON을 중간 트리 없이 C++ 구조체로 바로 읽음
+	//구조체는 같은 네임스페이스에서 JSON2_BIND(타입, 멤버...)로 등록하고 ParseInto로 읽음
+	//지원 타입: bool, 정수, 실수, std::string, std::vector, std::optional, std::map<std::string, T>, 등록된 구조체
+	//모르는 키는 건너뛰고, 문서에 없는 멤버는 원래 값을 유지함
+	template <typename T, typename = void>
+	struct Binder;
+
+	namespace bind_detail {
+		struct Sink;
+
+		//값을 받는 쪽의 동작. 형식이 맞지 않는 동작은 Mismatch로 채움
+		struct Ops {
+			void (*String)(void*, std::string_view);
+			void (*Int)(void*, int64_t);
+			void (*UInt)(void*, uint64_t);
+			void (*Float)(void*, JFloat);
+			void (*Bool)(void*, bool);
+			void (*Null)(void*);
+			Sink (*StartObject)(void*); //반환값이 멤버를 받음
+			Sink (*Member)(void*, std::string_view);
+			Sink (*StartArray)(void*); //반환값이 원소를 받음
+			Sink (*Element)(void*);
+		};
+
+		struct Sink {
+			void* target;
+			const Ops* ops;
+
+			template <typename U>
+			static Sink For(U& value) noexcept
+			{
+				return Sink{ &value, &Binder<U>::ops };
+			}
+		};
+
+		[[noreturn]] inline void Fail(const char* what)
+		{
+			throw std::runtime_error(std::string("[ParseInto] ") + what);
+		}
+
+		[[noreturn]] inline void Mismatch()
+		{
+			Fail("형식이 맞지 않습니다");
+		}
+
+		//모든 값을 받아서 버림. 모르는 키의 값을 건너뛸 때 씀
+		Sink Skip() noexcept;
+
+		constexpr Ops Mismatching()
+		{
+			return Ops{
+				[](void*, std::string_view) { Mismatch(); },
+				[](void*, int64_t) { Mismatch(); },
+				[](void*, uint64_t) { Mismatch(); },
+				[](void*, JFloat) { Mismatch(); },
+				[](void*, bool) { Mismatch(); },
+				[](void*) { Mismatch(); },
+				[](void*) -> Sink { Mismatch(); },
+				[](void*, std::string_view) -> Sink { Mismatch(); },
+				[](void*) -> Sink { Mismatch(); },
+				[](void*) -> Sink { Mismatch(); },
+			};
+		}
+
+		constexpr Ops Skipping()
+		{
+			return Ops{
+				[](void*, std::string_view) {},
+				[](void*, int64_t) {},
+				[](void*, uint64_t) {},
+				[](void*, JFloat) {},
+				[](void*, bool) {},
+				[](void*) {},
+				[](void*) { return Skip(); },
+				[](void*, std::string_view) { return Skip(); },
+				[](void*) { return Skip(); },
+				[](void*) { return Skip(); },
+			};
+		}
+
+		inline constexpr Ops skip_ops = Skipping();
+
+		inline Sink Skip() noexcept
+		{
+			return Sink{ nullptr, &skip_ops };
+		}
+
+		//키 분기용 해시. JSON2_BIND가 멤버 이름마다 case 상수로 씀 (이름끼리 겹치면 컴파일 오류)
+		constexpr uint32_t Fnv1a(std::string_view s) noexcept
+		{
+			uint32_t h = 2166136261u;
+			for (char c : s) {
+				h ^= static_cast<unsigned char>(c);
+				h *= 16777619u;
+			}
+			return h;
+		}
+
+		template <typename T>
+		T CheckedInt(int64_t v)
+		{
+			if constexpr (std::is_signed_v<T>) {
+				if (v < static_cast<int64_t>(std::numeric_limits<T>::min()) || v > static_cast<int64_t>(std::numeric_limits<T>::max()))
+					Fail("범위를 벗어난 숫자");
+			}
+			else {
+				if (v < 0 || static_cast<uint64_t>(v) > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+					Fail("범위를 벗어난 숫자");
+			}
+			return static_cast<T>(v);
+		}
+
+		template <typename T>
+		T CheckedUInt(uint64_t v)
+		{
+			if (v > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+				Fail("범위를 벗어난 숫자");
+			return static_cast<T>(v);
+		}
+
+		//JParser에 넘기는 핸들러. 열린 객체/배열마다 값을 받을 쪽을 쌓아 둠
+		class BindHandler {
+			struct Frame {
+				Sink container;
+				Sink member; //객체에서 마지막 키의 값을 받을 쪽
+				bool array;
+			};
+			std::vector<Frame> stack;
+			Sink root;
+
+			Sink Next()
+			{
+				if (stack.empty())
+					return root;
+				Frame& f = stack.back();
+				return f.array ? f.container.ops->Element(f.container.target) : f.member;
+			}
+		public:
+			explicit BindHandler(Sink root) : root(root)
+			{
+				stack.reserve(16);
+			}
+
+			void StartObject()
+			{
+				const Sink s = Next();
+				stack.push_back(Frame{ s.ops->StartObject(s.target), Skip(), false });
+			}
+
+			void Key(std::string_view key)
+			{
+				Frame& f = stack.back();
+				f.member = f.container.ops->Member(f.container.target, key);
+			}
+
+			void EndObject(size_t)
+			{
+				stack.pop_back();
+			}
+
+			void StartArray()
+			{
+				const Sink s = Next();
+				stack.push_back(Frame{ s.ops->StartArray(s.target), Skip(), true });
+			}
+
+			void EndArray(size_t)
+			{
+				stack.pop_back();
+			}
+
+			void String(std::string_view v) { const Sink s = Next(); s.ops->String(s.target, v); }
+			void Number(int64_t v) { const Sink s = Next(); s.ops->Int(s.target, v); }
+			void Number(uint64_t v) { const Sink s = Next(); s.ops->UInt(s.target, v); }
+			void Number(JFloat v) { const Sink s = Next(); s.ops->Float(s.target, v); }
+			void Bool(bool v) { const Sink s = Next(); s.ops->Bool(s.target, v); }
+			void Null() { const Sink s = Next(); s.ops->Null(s.target); }
+		};
+	}
+
+	template <>
+	struct Binder<bool> {
+		static constexpr bind_detail::Ops ops = [] {
+			bind_detail::Ops o = bind_detail::Mismatching();
+			o.Bool = [](void* p, bool v) { *static_cast<bool*>(p) = v; };
+			return o;
+		}();
+	};
+
+	template <typename T>
+	struct Binder<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+		static constexpr bind_detail::Ops ops = [] {
+			bind_detail::Ops o = bind_detail::Mismatching();
+			o.Int = [](void* p, int64_t v) { *static_cast<T*>(p) = bind_detail::CheckedInt<T>(v); };
+			o.UInt = [](void* p, uint64_t v) { *static_cast<T*>(p) = bind_detail::CheckedUInt<T>(v); };
+			o.Float = [](void*, JFloat) { bind_detail::Fail("정수가 아닙니다"); };
+			return o;
+		}();
+	};
+
+	template <typename T>
+	struct Binder<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+		static constexpr bind_detail::Ops ops = [] {
+			bind_detail::Ops o = bind_detail::Mismatching();
+			o.Int = [](void* p, int64_t v) { *static_cast<T*>(p) = static_cast<T>(v); };
+			o.UInt = [](void* p, uint64_t v) { *static_cast<T*>(p) = static_cast<T>(v); };
+			o.Float = [](void* p, JFloat v) { *static_cast<T*>(p) = static_cast<T>(v); };
+			return o;
+		}();
+	};
+
+	template <>
+	struct Binder<std::string> {
+		static constexpr bind_detail::Ops ops = [] {
+			bind_detail::Ops o = bind_detail::Mismatching();
+			o.String = [](void* p, std::string_view v) { static_cast<std::string*>(p)->assign(v.data(), v.size()); };
+			return o;
+		}();
+	};
+
+	//배열을 만나면 비우고 원소를 차례로 추가
+	template <typename T, typename A>
+	struct Binder<std::vector<T, A>> {
+		static constexpr bind_detail::Ops ops = [] {
+			bind_detail::Ops o = bind_detail::Mismatching();
+			o.StartArray = [](void* p) {
+				auto& v = *static_cast<std::vector<T, A>*>(p);
+				v.clear();
+				return bind_detail::Sink::For(v);
+			};
+			o.Element = [](void* p) {
+				auto& v = *static_cast<std::vector<T, A>*>(p);
+				v.emplace_back();
+				return bind_detail::Sink::For(v.back());
+			};
+			return o;
+		}();
+	};
+
+	//null이면 비우고, 다른 값이면 T로 읽음
+	template <typename T>
+	struct Binder<std::optional<T>> {
+		static T& Emplace(void* p)
+		{
+			return static_cast<std::optional<T>*>(p)->emplace();
+		}
+
+		static constexpr bind_detail::Ops ops = [] {
+			bind_detail::Ops o = bind_detail::Mismatching();
+			o.String = [](void* p, std::string_view v) { Binder<T>::ops.String(&Emplace(p), v); };
+			o.Int = [](void* p, int64_t v) { Binder<T>::ops.Int(&Emplace(p), v); };
+			o.UInt = [](void* p, uint64_t v) { Binder<T>::ops.UInt(&Emplace(p), v); };
+			o.Float = [](void* p, JFloat v) { Binder<T>::ops.Float(&Emplace(p), v); };
+			o.Bool = [](void* p, bool v) { Binder<T>::ops.Bool(&Emplace(p), v); };
+			o.Null = [](void* p) { static_cast<std::optional<T>*>(p)->reset(); };
+			o.StartObject = [](void* p) { return Binder<T>::ops.StartObject(&Emplace(p)); };
+			o.StartArray = [](void* p) { return Binder<T>::ops.StartArray(&Emplace(p)); };
+			return o;
+		}();
+	};
+
+	//객체를 만나면 비우고 모든 멤버를 추가
+	template <typename T, typename C, typename A>
+	struct Binder<std::map<std::string, T, C, A>> {
+		static constexpr bind_detail::Ops ops = [] {
+			bind_detail::Ops o = bind_detail::Mismatching();
+			o.StartObject = [](void* p) {
+				auto& m = *static_cast<std::map<std::string, T, C, A>*>(p);
+				m.clear();
+				return bind_detail::Sink::For(m);
+			};
+			o.Member = [](void* p, std::string_view key) {
+				auto& m = *static_cast<std::map<std::string, T, C, A>*>(p);
+				return bind_detail::Sink::For(m[std::string(key)]);
+			};
+			return o;
+		}();
+	};
+
+	//JSON2_BIND로 등록한 구조체. json2_bind_member는 ADL로 찾음
+	template <typename T>
+	struct Binder<T, std::void_t<decltype(json2_bind_member(std::declval<T&>(), std::string_view()))>> {
+		static constexpr bind_detail::Ops ops = [] {
+			bind_detail::Ops o = bind_detail::Mismatching();
+			o.StartObject = [](void* p) { return bind_detail::Sink::For(*static_cast<T*>(p)); };
+			o.Member = [](void* p, std::string_view key) { return json2_bind_member(*static_cast<T*>(p), key); };
+			return o;
+		}();
+	};
+
+	//Policy는 JParser의 파싱 정책. 예) ParseInto<TrustedPolicy>(str, out)
+	template <typename Policy = DefaultPolicy, typename T>
+	void ParseInto(std::istream& is, T& out)
+	{
+		bind_detail::BindHandler handler(bind_detail::Sink::For(out));
+		ParseSAX<Policy>(is, handler);
+	}
+
+	template <typename Policy = DefaultPolicy, typename T>
+	void ParseInto(std::string_view str, T& out, const StructuralIndex* index = nullptr)
+	{
+		bind_detail::BindHandler handler(bind_detail::Sink::For(out));
+		ParseSAX<Policy>(str, handler, index);
+	}
+
+	template <typename T, typename Policy = DefaultPolicy>
+	T ParseInto(std::string_view str, const StructuralIndex* index = nullptr)
+	{
+		T out{};
+		ParseInto<Policy>(str, out, index);
+		return out;
+	}
+}
+
+//멤버 이름을 키로 쓰는 구조체 등록. 구조체와 같은 네임스페이스에서 사용하며 멤버는 32개까지
+//예) struct User { int64_t id; std::string name; }; JSON2_BIND(User, id, name)
+#define JSON2_BIND(Type, ...) \
+	inline ::namespace_json_2::bind_detail::Sink json2_bind_member(Type& o, std::string_view key) \
+	{ \
+		switch (::namespace_json_2::bind_detail::Fnv1a(key)) { \
+		JSON2_BIND_EXPAND(JSON2_BIND_FOR_EACH(JSON2_BIND_CASE, o, __VA_ARGS__)) \
+		} \
+		return ::namespace_json_2::bind_detail::Skip(); \
+	}
+
+#define JSON2_BIND_CASE(o, field) \
+	case ::namespace_json_2::bind_detail::Fnv1a(#field): \
+		if (key == #field) \
+			return ::namespace_json_2::bind_detail::Sink::For(o.field); \
+		break;
+
+//MSVC 전통 전처리기에서도 __VA_ARGS__가 펼쳐지도록 JSON2_BIND_EXPAND로 감쌈
+#define JSON2_BIND_EXPAND(x) x
+#define JSON2_BIND_FE_1(m, o, x) m(o, x)
+#define JSON2_BIND_FE_2(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_1(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_3(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_2(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_4(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_3(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_5(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_4(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_6(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_5(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_7(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_6(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_8(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_7(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_9(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_8(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_10(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_9(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_11(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_10(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_12(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_11(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_13(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_12(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_14(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_13(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_15(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_14(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_16(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_15(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_17(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_16(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_18(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_17(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_19(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_18(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_20(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_19(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_21(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_20(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_22(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_21(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_23(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_22(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_24(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_23(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_25(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_24(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_26(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_25(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_27(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_26(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_28(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_27(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_29(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_28(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_30(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_29(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_31(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_30(m, o, __VA_ARGS__))
+#define JSON2_BIND_FE_32(m, o, x, ...) m(o, x) JSON2_BIND_EXPAND(JSON2_BIND_FE_31(m, o, __VA_ARGS__))
+#define JSON2_BIND_SELECT(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define JSON2_BIND_FOR_EACH(m, o, ...) JSON2_BIND_EXPAND(JSON2_BIND_SELECT(__VA_ARGS__, JSON2_BIND_FE_32, JSON2_BIND_FE_31, JSON2_BIND_FE_30, JSON2_BIND_FE_29, JSON2_BIND_FE_28, JSON2_BIND_FE_27, JSON2_BIND_FE_26, JSON2_BIND_FE_25, JSON2_BIND_FE_24, JSON2_BIND_FE_23, JSON2_BIND_FE_22, JSON2_BIND_FE_21, JSON2_BIND_FE_20, JSON2_BIND_FE_19, JSON2_BIND_FE_18, JSON2_BIND_FE_17, JSON2_BIND_FE_16, JSON2_BIND_FE_15, JSON2_BIND_FE_14, JSON2_BIND_FE_13, JSON2_BIND_FE_12, JSON2_BIND_FE_11, JSON2_BIND_FE_10, JSON2_BIND_FE_9, JSON2_BIND_FE_8, JSON2_BIND_FE_7, JSON2_BIND_FE_6, JSON2_BIND_FE_5, JSON2_BIND_FE_4, JSON2_BIND_FE_3, JSON2_BIND_FE_2, JSON2_BIND_FE_1)(m, o, __VA_ARGS__))
@@ -0,0 +1,47 @@
+#pragma once
+#include "json2.hpp"
+#include "json2_tape.hpp"
+#include "mapped_file.hpp"
+
+namespace namespace_json_2 {
+	//파일을 매핑해서 복사 없이 바로 파싱. 트리는 문자열을 복사하므로 매핑은 파싱이 끝나면 해제됨
+	template <typename Policy = DefaultPolicy>
+	JValue* ParseFile(const std::string& path, std::pmr::memory_resource* mr = nullptr, KeyPool* keys = nullptr)
+	{
+		const MappedFile file(path);
+		JBuffer is(file.view());
+		JValue* v = JValue::ParseWith<Policy>(is, mr, keys);
+		try {
+			ExpectEnd<Policy>(is);
+		}
+		catch (...) {
+			JValue::Release(v);
+			throw;
+		}
+		return v;
+	}
+
+	template <typename Policy = DefaultPolicy>
+	JValue* ParseFile(Document& doc, const std::string& path)
+	{
+		const MappedFile file(path);
+		return doc.Parse<Policy>(file.view());
+	}
+
+	inline Tape ParseTapeFile(const std::string& path)
+	{
+		const MappedFile file(path);
+		return Tape::Parse(file.view());
+	}
+
+	//Tape::SaveSnapshot으로 저장한 파일을 매핑한 채로 읽음. 객체가 살아 있는 동안 Root()의 TapeRef가 유효함
+	class SnapshotFile {
+		MappedFile file;
+		TapeView view;
+	public:
+		explicit SnapshotFile(const std::string& path) : file(path), view(TapeView::Open(file.data(), file.size())) {}
+
+		TapeRef Root() const noexcept { return view.Root(); }
+		const TapeView& View() const noexcept { return view; }
+	};
+}
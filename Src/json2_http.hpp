@@ -0,0 +1,77 @@
+#pragma once
+#include "json2.hpp"
+#include "json2_push.hpp"
+#include "http_request.h"
+
+namespace namespace_json_2 {
+	namespace http_detail {
+		//2xx가 아니면 본문은 JSON이 아닐 수 있으므로 읽기 전에 실패
+		inline void CheckStatus(const http_request::HTTPRespond& respond)
+		{
+			if (respond.code / 100 != 2) {
+				std::string msg("HTTP 오류 #");
+				msg += std::to_string(respond.code);
+				msg += ' ';
+				msg += respond.respondMessage;
+				throw std::runtime_error(msg);
+			}
+		}
+	}
+
+	//응답 본문을 받는 대로 JPushParser에 넣어 SAX 이벤트를 handler에 보냄. 본문을 버퍼에 모으거나 복사하지 않음
+	//future가 준비될 때까지 handler가 살아 있어야 함. 반환되는 HTTPRespond의 content는 비어 있음
+	template <typename Handler>
+	std::future<http_request::HTTPRespond> RequestSAX(const std::string& url, Handler& handler, http_request::ThreadPool* pool = nullptr)
+	{
+		const auto request_func = [&handler](std::string host, std::string uri) {
+			JPushParser<Handler> parser(handler);
+			auto respond = http_request::FetchStream(host, uri,
+				[&parser](const char* data, size_t size) { parser.feed(data, size); },
+				http_detail::CheckStatus);
+			parser.finish();
+			return respond;
+		};
+
+		std::string host, uri;
+		http_request::SplitURL(url, host, uri);
+		if (pool == nullptr)
+			return std::async(request_func, host, uri);
+		return pool->EnqueueTask(request_func, host, uri);
+	}
+
+	//응답 본문을 받는 대로 파싱해서 트리를 반환. 본문은 최상위 값 하나여야 함
+	//mr, keys는 JValue::ParseWith와 같고, future가 준비될 때까지 살아 있어야 함
+	inline std::future<JValue*> RequestJSON(const std::string& url, http_request::ThreadPool* pool = nullptr,
+		std::pmr::memory_resource* mr = nullptr, KeyPool* keys = nullptr)
+	{
+		const auto request_func = [mr, keys](std::string host, std::string uri) {
+			JValue* result = nullptr;
+			try {
+				JPushBuilder builder([&result](JValue* v) {
+					if (result != nullptr) {
+						JValue::Release(v);
+						throw json_parse_error("RequestJSON", "값 뒤에 다른 데이터가 있습니다", 0);
+					}
+					result = v;
+				}, mr, keys);
+				http_request::FetchStream(host, uri,
+					[&builder](const char* data, size_t size) { builder.feed(data, size); },
+					http_detail::CheckStatus);
+				builder.finish();
+				if (result == nullptr)
+					throw json_parse_error("RequestJSON", "본문이 비어 있습니다", 0);
+			}
+			catch (...) {
+				JValue::Release(result);
+				throw;
+			}
+			return result;
+		};
+
+		std::string host, uri;
+		http_request::SplitURL(url, host, uri);
+		if (pool == nullptr)
+			return std::async(request_func, host, uri);
+		return pool->EnqueueTask(request_func, host, uri);
+	}
+}
@@ -0,0 +1,397 @@
+#pragma once
+#include "json2.hpp"
+
+namespace namespace_json_2 {
+	//MessagePack 출력. JWriter처럼 호출자가 준 std::string 뒤에 이어 씀
+	//JParser의 Handler이기도 해서 ParseSAX(json, writer)로 JSON 원문을 트리 없이 바로 변환할 수 있음
+	//SAX로 쓸 때는 원소 수를 미리 모르므로 배열/맵 헤더를 항상 32비트 길이로 쓰고 끝에서 채움
+	class MsgPackWriter {
+		std::string& out;
+		std::vector<size_t> open; //SAX로 연 배열/맵 헤더의 위치
+
+		void Put(uint8_t b)
+		{
+			out += static_cast<char>(b);
+		}
+
+		template <typename U>
+		void PutBE(U v)
+		{
+			char buf[sizeof(U)];
+			for (size_t i = 0; i < sizeof(U); i++)
+				buf[i] = static_cast<char>(v >> (8 * (sizeof(U) - 1 - i)));
+			out.append(buf, sizeof(U));
+		}
+
+		void Header(uint8_t fix, uint8_t fix_limit, uint8_t tag16, uint8_t tag32, size_t n)
+		{
+			if (n < fix_limit) {
+				Put(static_cast<uint8_t>(fix | n));
+			}
+			else if (n <= 0xffff) {
+				Put(tag16);
+				PutBE(static_cast<uint16_t>(n));
+			}
+			else {
+				Put(tag32);
+				PutBE(static_cast<uint32_t>(n));
+			}
+		}
+
+		void Open(uint8_t tag32)
+		{
+			open.push_back(out.size());
+			Put(tag32);
+			PutBE(uint32_t(0));
+		}
+
+		void Close(size_t count)
+		{
+			const size_t at = open.back() + 1;
+			open.pop_back();
+			for (size_t i = 0; i < 4; i++)
+				out[at + i] = static_cast<char>(count >> (8 * (3 - i)));
+		}
+	public:
+		explicit MsgPackWriter(std::string& out) : out(out) {}
+		MsgPackWriter(const MsgPackWriter&) = delete;
+
+		std::string& Buffer() noexcept { return out; }
+
+		void Null() { Put(0xc0); }
+		void Bool(bool b) { Put(b ? 0xc3 : 0xc2); }
+
+		void Number(int64_t v)
+		{
+			if (v >= 0)
+				return Number(static_cast<uint64_t>(v));
+
+			if (v >= -32) {
+				Put(static_cast<uint8_t>(v));
+			}
+			else if (v >= INT8_MIN) {
+				Put(0xd0);
+				PutBE(static_cast<uint8_t>(v));
+			}
+			else if (v >= INT16_MIN) {
+				Put(0xd1);
+				PutBE(static_cast<uint16_t>(v));
+			}
+			else if (v >= INT32_MIN) {
+				Put(0xd2);
+				PutBE(static_cast<uint32_t>(v));
+			}
+			else {
+				Put(0xd3);
+				PutBE(static_cast<uint64_t>(v));
+			}
+		}
+
+		void Number(uint64_t v)
+		{
+			if (v < 0x80) {
+				Put(static_cast<uint8_t>(v));
+			}
+			else if (v <= 0xff) {
+				Put(0xcc);
+				PutBE(static_cast<uint8_t>(v));
+			}
+			else if (v <= 0xffff) {
+				Put(0xcd);
+				PutBE(static_cast<uint16_t>(v));
+			}
+			else if (v <= 0xffffffff) {
+				Put(0xce);
+				PutBE(static_cast<uint32_t>(v));
+			}
+			else {
+				Put(0xcf);
+				PutBE(v);
+			}
+		}
+
+		//항상 float64로 써서 값이 그대로 보존됨
+		void Number(JFloat v)
+		{
+			const double d = v;
+			uint64_t bits;
+			memcpy(&bits, &d, sizeof(bits));
+			Put(0xcb);
+			PutBE(bits);
+		}
+
+		void String(std::string_view s)
+		{
+			if (s.size() < 32) {
+				Put(static_cast<uint8_t>(0xa0 | s.size()));
+			}
+			else if (s.size() <= 0xff) {
+				Put(0xd9);
+				PutBE(static_cast<uint8_t>(s.size()));
+			}
+			else if (s.size() <= 0xffff) {
+				Put(0xda);
+				PutBE(static_cast<uint16_t>(s.size()));
+			}
+			else {
+				Put(0xdb);
+				PutBE(static_cast<uint32_t>(s.size()));
+			}
+			out.append(s.data(), s.size());
+		}
+
+		void ArrayHeader(size_t n) { Header(0x90, 16, 0xdc, 0xdd, n); }
+		void MapHeader(size_t n) { Header(0x80, 16, 0xde, 0xdf, n); }
+
+		void Value(const JValue* v);
+
+		//SAX 이벤트
+		void StartObject() { Open(0xdf); }
+		void Key(std::string_view key) { String(key); }
+		void EndObject(size_t count) { Close(count); }
+		void StartArray() { Open(0xdd); }
+		void EndArray(size_t count) { Close(count); }
+	};
+
+	inline void MsgPackWriter::Value(const JValue* v)
+	{
+		switch (v->type) {
+		case VALUE_TYPE::JLITERAL: {
+			auto l = static_cast<const JLiteral*>(v);
+			if (l->IsNull())
+				Null();
+			else
+				Bool(l->Est());
+			break;
+		}
+		case VALUE_TYPE::NUMBER: {
+			auto n = static_cast<const JNumber*>(v);
+			switch (n->Kind()) {
+			case JNumber::KIND::INT:
+				Number(n->asInt64());
+				break;
+			case JNumber::KIND::UINT:
+				Number(n->asUInt64());
+				break;
+			default:
+				Number(n->asFloat());
+			}
+			break;
+		}
+		case VALUE_TYPE::STRING:
+			String(*static_cast<const JString*>(v));
+			break;
+		case VALUE_TYPE::ARRAY: {
+			auto a = static_cast<const JArray*>(v);
+			ArrayHeader(a->size());
+			for (const JValue* e : *a)
+				Value(e);
+			break;
+		}
+		case VALUE_TYPE::OBJECT: {
+			auto o = static_cast<const JObject*>(v);
+			MapHeader(o->size());
+			for (const auto& m : *o) {
+				String(std::string_view(m.first));
+				Value(m.second);
+			}
+			break;
+		}
+		}
+	}
+
+	//MessagePack을 읽어 JParser와 같은 SAX 이벤트를 Handler에 보냄
+	//bin은 문자열로 읽고, ext와 문자열이 아닌 맵 키는 JSON으로 옮길 수 없으므로 오류
+	//문자열 이벤트의 string_view는 입력 버퍼를 가리킴
+	template <typename Handler>
+	class MsgPackParser {
+		const uint8_t* const first;
+		const uint8_t* p;
+		const uint8_t* const last;
+		Handler& handler;
+		size_t depth = 0;
+
+		[[noreturn]] void Fail(const char* what) const
+		{
+			throw json_parse_error("MsgPackParser", what, static_cast<int>(p - first));
+		}
+
+		//0x91이 계속되는 입력처럼 중첩이 깊으면 스택이 넘치므로 재귀 전에 깊이를 제한
+		void Enter()
+		{
+			if (++depth > max_depth)
+				Fail("중첩이 너무 깊습니다");
+		}
+
+		void Need(size_t n) const
+		{
+			if (static_cast<size_t>(last - p) < n)
+				Fail("비정상적 스트림 종료");
+		}
+
+		template <typename U>
+		U Read()
+		{
+			Need(sizeof(U));
+			U v = 0;
+			for (size_t i = 0; i < sizeof(U); i++)
+				v = static_cast<U>((v << 8) | p[i]);
+			p += sizeof(U);
+			return v;
+		}
+
+		std::string_view Bytes(size_t n)
+		{
+			Need(n);
+			const std::string_view s(reinterpret_cast<const char*>(p), n);
+			p += n;
+			return s;
+		}
+
+		//tag가 문자열 형식이면 길이, 아니면 -1
+		int64_t StringLength(uint8_t tag)
+		{
+			if ((tag & 0xe0) == 0xa0)
+				return tag & 0x1f;
+			switch (tag) {
+			case 0xd9: case 0xc4: return Read<uint8_t>();
+			case 0xda: case 0xc5: return Read<uint16_t>();
+			case 0xdb: case 0xc6: return Read<uint32_t>();
+			default: return -1;
+			}
+		}
+
+		void Signed(int64_t v)
+		{
+			handler.Number(v);
+		}
+
+		void Unsigned(uint64_t v)
+		{
+			if (v <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+				handler.Number(static_cast<int64_t>(v));
+			else
+				handler.Number(v);
+		}
+
+		void ParseArray(size_t n)
+		{
+			Enter();
+			handler.StartArray();
+			for (size_t i = 0; i < n; i++)
+				ParseValue();
+			handler.EndArray(n);
+			depth--;
+		}
+
+		void ParseMap(size_t n)
+		{
+			Enter();
+			handler.StartObject();
+			for (size_t i = 0; i < n; i++) {
+				Need(1);
+				const int64_t len = StringLength(*p++);
+				if (len < 0) {
+					--p;
+					Fail("키는 문자열이어야 합니다");
+				}
+				handler.Key(Bytes(static_cast<size_t>(len)));
+				ParseValue();
+			}
+			handler.EndObject(n);
+			depth--;
+		}
+	public:
+		static constexpr size_t max_depth = 1024;
+
+		MsgPackParser(std::string_view data, Handler& handler)
+			: first(reinterpret_cast<const uint8_t*>(data.data())), p(first), last(first + data.size()), handler(handler) {}
+		MsgPackParser(const MsgPackParser&) = delete;
+
+		size_t Consumed() const noexcept { return p - first; }
+
+		void ParseValue()
+		{
+			Need(1);
+			const uint8_t tag = *p++;
+
+			if (tag < 0x80)
+				return Unsigned(tag);
+			if (tag >= 0xe0)
+				return Signed(static_cast<int8_t>(tag));
+			if ((tag & 0xf0) == 0x80)
+				return ParseMap(tag & 0x0f);
+			if ((tag & 0xf0) == 0x90)
+				return ParseArray(tag & 0x0f);
+
+			const int64_t len = StringLength(tag);
+			if (len >= 0)
+				return handler.String(Bytes(static_cast<size_t>(len)));
+
+			switch (tag) {
+			case 0xc0: handler.Null(); break;
+			case 0xc2: handler.Bool(false); break;
+			case 0xc3: handler.Bool(true); break;
+			case 0xca: {
+				const uint32_t bits = Read<uint32_t>();
+				float f;
+				memcpy(&f, &bits, sizeof(f));
+				handler.Number(static_cast<JFloat>(f));
+				break;
+			}
+			case 0xcb: {
+				const uint64_t bits = Read<uint64_t>();
+				double d;
+				memcpy(&d, &bits, sizeof(d));
+				handler.Number(static_cast<JFloat>(d));
+				break;
+			}
+			case 0xcc: Unsigned(Read<uint8_t>()); break;
+			case 0xcd: Unsigned(Read<uint16_t>()); break;
+			case 0xce: Unsigned(Read<uint32_t>()); break;
+			case 0xcf: Unsigned(Read<uint64_t>()); break;
+			case 0xd0: Signed(static_cast<int8_t>(Read<uint8_t>())); break;
+			case 0xd1: Signed(static_cast<int16_t>(Read<uint16_t>())); break;
+			case 0xd2: Signed(static_cast<int32_t>(Read<uint32_t>())); break;
+			case 0xd3: Signed(static_cast<int64_t>(Read<uint64_t>())); break;
+			case 0xdc: ParseArray(Read<uint16_t>()); break;
+			case 0xdd: ParseArray(Read<uint32_t>()); break;
+			case 0xde: ParseMap(Read<uint16_t>()); break;
+			case 0xdf: ParseMap(Read<uint32_t>()); break;
+			default:
+				--p;
+				Fail("지원하지 않는 형식");
+			}
+		}
+	};
+
+	//값 하나를 읽어 Handler에 보내고 읽은 바이트 수를 반환. 뒤에 이어지는 값은 다시 호출해서 읽음
+	template <typename Handler>
+	size_t ParseMsgPack(std::string_view data, Handler& handler)
+	{
+		MsgPackParser<Handler> parser(data, handler);
+		parser.ParseValue();
+		return parser.Consumed();
+	}
+
+	inline void ToMsgPack(const JValue* v, std::string& out)
+	{
+		MsgPackWriter(out).Value(v);
+	}
+
+	inline std::string ToMsgPack(const JValue* v)
+	{
+		std::string out;
+		ToMsgPack(v, out);
+		return out;
+	}
+
+	//data 전체가 값 하나여야 함. mr, keys는 JValue::ParseWith와 같음
+	inline JValue* FromMsgPack(std::string_view data, std::pmr::memory_resource* mr = nullptr, KeyPool* keys = nullptr)
+	{
+		JDomBuilder builder(mr, keys);
+		if (ParseMsgPack(data, builder) != data.size())
+			throw json_parse_error("FromMsgPack", "값 뒤에 다른 데이터가 있습니다", static_cast<int>(data.size()));
+		return builder.Take();
+	}
+}
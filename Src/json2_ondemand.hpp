@@ -0,0 +1,346 @@
+#pragma once
+#include "json2.hpp"
+
+namespace namespace_json_2 {
+	//원문 위를 움직이는 커서. 필요 없는 하위 값은 괄호 짝만 맞춰 건너뛰고 아무것도 할당하지 않음
+	//엄격한 JSON만 다룸 (큰따옴표 문자열, 따옴표로 감싼 키)
+	class JCursor {
+		const char* first;
+		const char* last;
+		const char* cur; //현재 값의 첫 문자
+
+		[[noreturn]] void Fail(const char* what, const char* at) const
+		{
+			throw json_parse_error("JCursor", what, static_cast<int>(at - first));
+		}
+
+		const char* SkipSpaces(const char* p) const noexcept
+		{
+			while (p != last && simd_detail::IsSpace(static_cast<unsigned char>(*p)))
+				++p;
+			return p;
+		}
+
+		//p는 여는 따옴표, 반환값은 닫는 따옴표 다음
+		const char* SkipString(const char* p) const
+		{
+			++p;
+			while (true) {
+				const char* q = static_cast<const char*>(memchr(p, '"', last - p));
+				if (q == nullptr)
+					Fail("문자열 끝이 없습니다", p);
+				size_t slashes = 0; //따옴표 앞의 연속된 '\\' 개수가 짝수일 때만 문자열 끝
+				for (const char* b = q; b != p && *(b - 1) == '\\'; --b)
+					slashes++;
+				if (slashes % 2 == 0)
+					return q + 1;
+				p = q + 1;
+			}
+		}
+
+		//p는 값의 첫 문자, 반환값은 값 바로 다음
+		const char* SkipValue(const char* p) const
+		{
+			if (p == last)
+				Fail("비정상적 스트림 종료", p);
+
+			switch (*p) {
+			case '"':
+				return SkipString(p);
+			case '{':
+			case '[': {
+				size_t depth = 0;
+				while ((p = FindQuoteOrBracket(p, last)) != last) {
+					switch (*p) {
+					case '"':
+						p = SkipString(p);
+						continue;
+					case '{':
+					case '[':
+						depth++;
+						break;
+					case '}':
+					case ']':
+						if (--depth == 0)
+							return p + 1;
+						break;
+					}
+					++p;
+				}
+				Fail("괄호 짝이 맞지 않습니다", p);
+			}
+			default:
+				while (p != last && *p != ',' && *p != '}' && *p != ']' && !simd_detail::IsSpace(static_cast<unsigned char>(*p)))
+					++p;
+				return p;
+			}
+		}
+
+		//raw는 따옴표 안쪽. 이스케이프가 있을 때만 풀어서 비교
+		static bool KeyEquals(std::string_view raw, std::string_view key)
+		{
+			if (raw.find('\\') == std::string_view::npos)
+				return raw == key;
+
+			thread_local std::string unescaped;
+			unescaped.clear();
+			JBuffer is(raw.data() - 1, raw.size() + 2);
+			JString::ParseStringInto(is, unescaped);
+			return unescaped == key;
+		}
+
+		static void Fill(const PathSet& paths, size_t n, std::string_view raw, std::string_view* out)
+		{
+			const auto& node = paths.Nodes()[n];
+			for (size_t t : node.targets)
+				out[t] = raw;
+			for (size_t c : node.children)
+				Fill(paths, c, raw, out);
+		}
+
+		//중복 키가 다시 나오면 앞의 값에서 찾은 결과를 지움
+		static void Clear(const PathSet& paths, size_t n, std::string_view* out)
+		{
+			const auto& node = paths.Nodes()[n];
+			for (size_t t : node.targets)
+				out[t] = std::string_view();
+			for (size_t c : node.children)
+				Clear(paths, c, out);
+		}
+
+		//p는 노드 n에 해당하는 값의 첫 문자
+		//중복 키는 트리처럼 마지막 값을 쓰므로 객체는 끝까지 보고, 배열은 찾을 원소가 모두 끝나면 나머지를 보지 않음
+		void Extract(const PathSet& paths, size_t n, const char* p, std::string_view* out) const
+		{
+			const auto& nodes = paths.Nodes();
+			const auto& node = nodes[n];
+			if (!node.targets.empty()) {
+				const std::string_view raw(p, SkipValue(p) - p);
+				for (size_t t : node.targets)
+					out[t] = raw;
+			}
+
+			size_t left = node.children.size();
+			if (left == 0)
+				return;
+
+			if (*p != '{' && *p != '[') { //find()처럼 스칼라 값에서 멈춤
+				const std::string_view raw(p, SkipValue(p) - p);
+				for (size_t c : node.children)
+					Fill(paths, c, raw, out);
+				return;
+			}
+
+			const bool object = *p == '{';
+			const char close = object ? '}' : ']';
+			p = SkipSpaces(p + 1);
+			if (p != last && *p == close)
+				return;
+
+			for (size_t i = 0; p != last; i++) {
+				if (object) {
+					if (*p != '"')
+						Fail("키는 \"로 시작해야 합니다", p);
+					const char* key_end = SkipString(p);
+					const std::string_view raw(p + 1, key_end - p - 2);
+
+					p = SkipSpaces(key_end);
+					if (p == last || *p != ':')
+						Fail("':' 없음", p);
+					p = SkipSpaces(p + 1);
+
+					size_t match = 0;
+					for (size_t c : node.children) {
+						if (KeyEquals(raw, nodes[c].key)) {
+							match = c;
+							break;
+						}
+					}
+					if (match != 0) {
+						Clear(paths, match, out);
+						Extract(paths, match, p, out);
+					}
+				}
+				else {
+					for (size_t c : node.children) { //"0"과 "00"처럼 같은 인덱스를 다르게 쓴 선택자는 노드가 따로 있음
+						if (nodes[c].index == i) {
+							Extract(paths, c, p, out);
+							left--;
+						}
+					}
+					if (left == 0)
+						return;
+				}
+
+				p = SkipSpaces(SkipValue(p));
+				if (p == last)
+					break;
+				if (*p == close)
+					return;
+				if (*p != ',')
+					Fail(object ? "콤마 없이 다음 값을 읽을 수 없습니다" : "불완전한 배열", p);
+				p = SkipSpaces(p + 1);
+			}
+			Fail("비정상적 스트림 종료", p);
+		}
+	public:
+		JCursor(std::string_view json)
+			: first(json.data()), last(json.data() + json.size()), cur(json.data())
+		{
+			cur = SkipSpaces(cur);
+			if (cur == last)
+				Fail("비정상적 스트림 종료", cur);
+		}
+
+		VALUE_TYPE type() const noexcept
+		{
+			switch (*cur) {
+			case '{':
+				return VALUE_TYPE::OBJECT;
+			case '[':
+				return VALUE_TYPE::ARRAY;
+			case '"':
+				return VALUE_TYPE::STRING;
+			case 't':
+			case 'f':
+			case 'n':
+				return VALUE_TYPE::JLITERAL;
+			default:
+				return VALUE_TYPE::NUMBER;
+			}
+		}
+
+		//현재 객체의 멤버로 이동. 없으면 false이고 위치는 그대로
+		//중복 키는 트리처럼 마지막 값을 쓰므로 객체 끝까지 봄
+		bool Child(std::string_view key)
+		{
+			if (*cur != '{')
+				return false;
+
+			const char* p = SkipSpaces(cur + 1);
+			if (p != last && *p == '}')
+				return false;
+
+			const char* found = nullptr;
+			while (p != last) {
+				if (*p != '"')
+					Fail("키는 \"로 시작해야 합니다", p);
+				const char* key_end = SkipString(p);
+				const std::string_view raw(p + 1, key_end - p - 2);
+
+				p = SkipSpaces(key_end);
+				if (p == last || *p != ':')
+					Fail("':' 없음", p);
+				p = SkipSpaces(p + 1);
+
+				if (KeyEquals(raw, key))
+					found = p;
+
+				p = SkipSpaces(SkipValue(p));
+				if (p == last)
+					break;
+				if (*p == '}') {
+					if (found == nullptr)
+						return false;
+					cur = found;
+					return true;
+				}
+				if (*p != ',')
+					Fail("콤마 없이 다음 값을 읽을 수 없습니다", p);
+				p = SkipSpaces(p + 1);
+			}
+			Fail("비정상적 스트림 종료", p);
+		}
+
+		//현재 배열의 n번째 원소로 이동. 없으면 false이고 위치는 그대로
+		bool Child(size_t n)
+		{
+			if (*cur != '[')
+				return false;
+
+			const char* p = SkipSpaces(cur + 1);
+			if (p != last && *p == ']')
+				return false;
+
+			while (p != last) {
+				if (n-- == 0) {
+					cur = p;
+					return true;
+				}
+
+				p = SkipSpaces(SkipValue(p));
+				if (p == last)
+					break;
+				if (*p == ']')
+					return false;
+				if (*p != ',')
+					Fail("불완전한 배열", p);
+				p = SkipSpaces(p + 1);
+			}
+			Fail("비정상적 스트림 종료", p);
+		}
+
+		//find()와 같은 선택자 문법으로 이동. 스칼라 값에서 경로가 남으면 find()처럼 멈춤
+		bool Select(const CompiledPath& path)
+		{
+			for (const auto& step : path.Steps()) {
+				const VALUE_TYPE t = type();
+				if (t == VALUE_TYPE::OBJECT) {
+					if (!Child(std::string_view(step.key)))
+						return false;
+				}
+				else if (t == VALUE_TYPE::ARRAY) {
+					if (step.index == CompiledPath::npos)
+						throw std::invalid_argument("배열 인덱스가 숫자가 아닙니다");
+					if (!Child(step.index))
+						return false;
+				}
+				else {
+					break;
+				}
+			}
+			return true;
+		}
+
+		bool Select(const std::string& select, char delim = '.')
+		{
+			return Select(*CompiledPath::Cached(select, delim));
+		}
+
+		//현재 값에서 paths의 모든 경로를 한 번 훑어서 찾음. 중복 키는 find()처럼 마지막 값을 씀
+		//out[i]는 i번째 선택자 값의 원문이며 경로가 없으면 data()가 nullptr인 빈 view. out은 paths.size()개 이상이어야 함
+		void Extract(const PathSet& paths, std::string_view* out) const
+		{
+			std::fill(out, out + paths.size(), std::string_view());
+			Extract(paths, 0, cur, out);
+		}
+
+		//현재 값의 원문
+		std::string_view Raw() const
+		{
+			return std::string_view(cur, SkipValue(cur) - cur);
+		}
+
+		//현재 값만 트리로 만듦
+		JValue* Materialize(std::pmr::memory_resource* mr = nullptr) const
+		{
+			JBuffer is(Raw());
+			return JValue::ParseWith(is, mr);
+		}
+	};
+
+	//원문에서 선택자 경로의 값만 트리로 만듦. 경로가 없으면 std::out_of_range
+	inline JValue* find(std::string_view json, const std::string& select, char delim = '.') {
+		JCursor cursor(json);
+		if (!cursor.Select(select, delim))
+			throw std::out_of_range("경로가 없습니다");
+		return cursor.Materialize();
+	}
+
+	//원문에서 여러 경로의 값 원문을 한 번에 찾음. 없는 경로는 빈 view
+	inline std::vector<std::string_view> find(std::string_view json, const PathSet& paths) {
+		std::vector<std::string_view> out(paths.size());
+		JCursor(json).Extract(paths, out.data());
+		return out;
+	}
+}
@@ -0,0 +1,257 @@
+#pragma once
+#include "json2.hpp"
+#include "thread_pool.hpp"
+#include <deque>
+#include <istream>
+#include <memory>
+
+namespace namespace_json_2 {
+	using http_request::ThreadPool;
+
+	namespace parallel_detail {
+		using Values = std::vector<JValue*>;
+
+		inline void ReleaseAll(const Values& values, size_t from = 0) noexcept
+		{
+			for (size_t i = from; i < values.size(); i++)
+				JValue::Release(values[i]);
+		}
+
+		//chunk의 각 줄을 하나의 문서로 파싱. 공백뿐인 줄은 건너뜀
+		//offset은 전체 입력에서 chunk의 위치이며 오류 메시지에 줄 시작 위치로 표시됨
+		inline Values ParseLineChunk(std::string_view chunk, size_t offset, KeyPool* keys)
+		{
+			Values values;
+			size_t pos = 0;
+			try {
+				while (pos < chunk.size()) {
+					size_t nl = chunk.find('\n', pos);
+					if (nl == std::string_view::npos)
+						nl = chunk.size();
+
+					JBuffer is(chunk.substr(pos, nl - pos));
+					if (is.skip_spaces()) {
+						values.push_back(JValue::ParseWith(is, nullptr, keys));
+						if (is.skip_spaces())
+							throw JSONLIB_THROW_ERROR("한 줄에 값이 둘 이상입니다");
+					}
+					pos = nl + 1;
+				}
+			}
+			catch (std::exception& e) {
+				ReleaseAll(values);
+				std::ostringstream what_full;
+				what_full << "[ParseLines:" << offset + pos << ']' << e.what();
+				throw std::runtime_error(what_full.str());
+			}
+			return values;
+		}
+
+		//배열 원소 [bg, end)를 파싱. end는 마지막 원소 뒤의 ',' 또는 ']' 위치
+		//JBuffer는 전체 입력 위에 만들어 index와 오류 위치가 그대로 맞음
+		//경계 탐색이 엄격한 JSON만 다루므로 원소도 StrictPolicy로 파싱 (느슨한 입력이 잘못 잘린 채 통과하지 않도록)
+		inline Values ParseElements(std::string_view data, const StructuralIndex* index, size_t bg, size_t end, KeyPool* keys)
+		{
+			Values values;
+			JBuffer is(data, index);
+			is.skip(bg);
+			try {
+				while (true) {
+					values.push_back(JValue::ParseWith<StrictPolicy>(is, nullptr, keys));
+					SkipSpaces(is);
+					const size_t pos = static_cast<size_t>(is.tellg());
+					if (pos == end)
+						break;
+					if (pos > end || is.get() != ',')
+						throw JSONLIB_THROW_ERROR("불완전한 배열");
+				}
+			}
+			catch (...) {
+				ReleaseAll(values);
+				throw;
+			}
+			return values;
+		}
+
+		//조각 결과를 입력 순서대로 내보내고, 처리 중인 조각 수를 window로 제한
+		class ChunkDispatcher {
+			std::deque<std::future<Values>> pending;
+			const size_t window;
+		public:
+			explicit ChunkDispatcher(const ThreadPool& pool) : window(pool.size() * 2) {}
+			ChunkDispatcher(const ChunkDispatcher&) = delete;
+			~ChunkDispatcher()
+			{
+				for (auto& f : pending) { //예외로 빠져나갈 때 남은 작업을 기다리고 결과를 해제
+					try {
+						ReleaseAll(f.get());
+					}
+					catch (std::exception&) {}
+				}
+			}
+
+			template <typename Callback>
+			void Emit(Callback& callback)
+			{
+				auto f = std::move(pending.front()); //get()이 던지면 빈 future가 남지 않도록 먼저 꺼냄
+				pending.pop_front();
+				Values values = f.get();
+				for (size_t i = 0; i < values.size(); i++) {
+					try {
+						callback(values[i]);
+					}
+					catch (...) {
+						ReleaseAll(values, i + 1); //values[i]는 이미 callback에게 넘어감
+						throw;
+					}
+				}
+			}
+
+			template <typename Callback>
+			void MakeRoom(Callback& callback)
+			{
+				while (pending.size() >= window)
+					Emit(callback);
+			}
+
+			void Push(std::future<Values>&& f)
+			{
+				pending.push_back(std::move(f));
+			}
+
+			template <typename Callback>
+			void Finish(Callback& callback)
+			{
+				while (!pending.empty())
+					Emit(callback);
+			}
+		};
+	}
+
+	//줄 단위 JSON(NDJSON, JSON Lines)을 pool에서 병렬로 파싱
+	//입력을 chunk_size 근처의 줄 경계에서 잘라 작업으로 보내고, 결과는 입력 순서대로 호출 스레드에서 callback(JValue*)으로 전달
+	//callback이 값의 소유권을 가짐. pool의 작업 스레드에서 호출하면 교착될 수 있음
+	//data는 함수가 끝날 때까지 유효해야 함. keys가 주어지면 모든 작업 스레드가 객체 키를 공유 풀에 등록
+	template <typename Callback>
+	void ParseLines(std::string_view data, ThreadPool& pool, Callback&& callback, size_t chunk_size = 1 << 20, KeyPool* keys = nullptr)
+	{
+		parallel_detail::ChunkDispatcher dispatcher(pool);
+		size_t pos = 0;
+		while (pos < data.size()) {
+			size_t end = pos + chunk_size < data.size() ? data.find('\n', pos + chunk_size) : std::string_view::npos;
+			end = end == std::string_view::npos ? data.size() : end + 1;
+
+			dispatcher.MakeRoom(callback);
+			dispatcher.Push(pool.EnqueueTask(parallel_detail::ParseLineChunk, data.substr(pos, end - pos), pos, keys));
+			pos = end;
+		}
+		dispatcher.Finish(callback);
+	}
+
+	//스트림(파일 등)에서 chunk_size씩 읽어 병렬로 파싱. 메모리 사용량은 chunk_size * pool 크기 * 2 정도로 유지됨
+	template <typename Callback>
+	void ParseLines(std::istream& is, ThreadPool& pool, Callback&& callback, size_t chunk_size = 1 << 20, KeyPool* keys = nullptr)
+	{
+		parallel_detail::ChunkDispatcher dispatcher(pool);
+		std::string carry; //다음 조각으로 넘길 끝나지 않은 줄
+		size_t offset = 0;
+		while (is) {
+			std::string buf = std::move(carry);
+			carry.clear();
+			const size_t old = buf.size();
+			buf.resize(old + chunk_size);
+			is.read(&buf[old], chunk_size);
+			buf.resize(old + static_cast<size_t>(is.gcount()));
+
+			if (is) {
+				const size_t nl = buf.rfind('\n');
+				if (nl == std::string::npos) { //한 줄이 chunk_size보다 긺
+					carry = std::move(buf);
+					continue;
+				}
+				carry.assign(buf, nl + 1, std::string::npos);
+				buf.resize(nl + 1);
+			}
+			if (buf.empty())
+				continue;
+
+			const size_t size = buf.size();
+			dispatcher.MakeRoom(callback);
+			dispatcher.Push(pool.EnqueueTask([keys](const std::string& chunk, size_t at) {
+				return parallel_detail::ParseLineChunk(chunk, at, keys);
+			}, std::move(buf), offset));
+			offset += size;
+		}
+		dispatcher.Finish(callback);
+	}
+
+	//원소가 아주 많은 최상위 배열을 pool에서 병렬로 파싱해 하나의 JArray로 만듦
+	//구조 인덱스로 깊이 1의 ','를 찾아 chunk_size 근처에서 원소 단위로 자르고, 조각 결과를 원래 순서대로 이어 붙임
+	//엄격한 JSON만 허용 (따옴표 없는 키 등은 경계 탐색을 틀리게 함)
+	inline JArray* ParseArrayParallel(std::string_view data, ThreadPool& pool, size_t chunk_size = 1 << 20, KeyPool* keys = nullptr)
+	{
+		const StructuralIndex index(data.data(), data.size());
+		const size_t n = data.size();
+		JBuffer is(data, &index); //오류 위치 표시용
+
+		const size_t open = index.NextNonSpace(0);
+		if (open == n || data[open] != '[')
+			throw JSONLIB_THROW_ERROR("배열은 '['로 시작해야 합니다");
+
+		std::unique_ptr<JArray> arr(new JArray);
+		auto append = [&arr](JValue* v) {
+			try {
+				arr->push_back(v);
+			}
+			catch (...) {
+				JValue::Release(v);
+				throw;
+			}
+		};
+
+		parallel_detail::ChunkDispatcher dispatcher(pool); //index보다 먼저 소멸하여 남은 작업을 기다림
+		auto submit = [&](size_t bg, size_t end) {
+			dispatcher.MakeRoom(append);
+			dispatcher.Push(pool.EnqueueTask(parallel_detail::ParseElements, data, &index, bg, end, keys));
+		};
+
+		size_t chunk_bg = open + 1;
+		size_t close = n;
+		size_t depth = 0;
+		for (size_t p = index.NextStructural(open); p < n; p = index.NextStructural(p + 1)) {
+			const char c = data[p];
+			if (c == '[' || c == '{') {
+				depth++;
+			}
+			else if (c == ']' || c == '}') {
+				if (--depth == 0) {
+					close = p;
+					break;
+				}
+			}
+			else if (c == ',' && depth == 1 && p - chunk_bg >= chunk_size) {
+				submit(chunk_bg, p);
+				chunk_bg = p + 1;
+			}
+		}
+
+		if (close == n || data[close] != ']') {
+			is.skip(close);
+			throw JSONLIB_THROW_ERROR("비정상적 스트림 종료");
+		}
+		if (const size_t rest = index.NextNonSpace(close + 1); rest != n) {
+			is.skip(rest);
+			throw JSONLIB_THROW_ERROR("배열 뒤에 다른 값이 있습니다");
+		}
+		if (index.NextNonSpace(chunk_bg) != close) { //빈 배열이 아니거나 마지막 조각이 남음
+			submit(chunk_bg, close);
+		}
+		else if (chunk_bg != open + 1) { //마지막 ',' 뒤에 원소가 없음
+			is.skip(close);
+			throw JSONLIB_THROW_ERROR("불완전한 배열");
+		}
+
+		dispatcher.Finish(append);
+		return arr.release();
+	}
+}
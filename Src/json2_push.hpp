@@ -0,0 +1,390 @@
+#pragma once
+#include "json2.hpp"
+#include <climits>
+
+namespace namespace_json_2 {
+	namespace push_detail {
+		template <typename H, typename = void>
+		struct HasEndValue : std::false_type {};
+
+		template <typename H>
+		struct HasEndValue<H, std::void_t<decltype(std::declval<H&>().EndValue())>> : std::true_type {};
+
+		inline bool IsNumberChar(char c) noexcept
+		{
+			return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+		}
+	}
+
+	//조각으로 들어오는 입력을 받는 푸시 파서. 상태를 유지하므로 값, 문자열, 숫자 중간에서 잘려도 다음 feed에서 이어서 읽음
+	//Handler는 JParser와 같은 SAX 이벤트를 받고, EndValue()가 있으면 최상위 값이 끝날 때마다 호출됨
+	//공백으로 구분된 여러 최상위 값을 차례로 받을 수 있음 (NDJSON 등)
+	//표준 JSON만 허용 (StrictPolicy와 같음)
+	template <typename Handler>
+	class JPushParser {
+		enum class State : uint8_t {
+			VALUE, //값 시작
+			FIRST_ELEMENT, //'[' 다음: 값 또는 ']'
+			FIRST_KEY, //'{' 다음: 키 또는 '}'
+			KEY, //',' 다음의 키
+			COLON,
+			AFTER_VALUE, //배열/객체 안: ',' 또는 닫는 괄호
+			STRING,
+			NUMBER,
+			LITERAL,
+		};
+
+		struct Frame {
+			char open;
+			size_t count;
+		};
+
+		Handler& handler;
+		State state = State::VALUE;
+		std::vector<Frame> stack;
+		std::string token; //문자열, 키, 숫자가 조각에 걸쳐 있을 때 모아 두는 버퍼
+		bool key = false; //STRING이 키인지
+		int escape = 0; //0: 없음, 1: '\\' 다음, 2~5: \u 다음 16진수 자리
+		char hex[5] = { 0 };
+		const char* literal = nullptr;
+		size_t literal_pos = 0;
+		size_t offset = 0; //이전 feed까지 받은 바이트 수
+		const char* chunk = nullptr; //현재 feed의 시작 (오류 위치 계산용)
+		size_t values = 0;
+		bool need_space = false; //최상위 스칼라 값 뒤에는 공백이나 입력 끝이 와야 함 (12true 같은 입력 거부)
+
+		[[noreturn]] void Fail(const char* what, const char* at) const
+		{
+			throw json_parse_error("JPushParser", what, static_cast<int>(offset + (at - chunk)));
+		}
+
+		void EndValue(bool scalar = true)
+		{
+			if (stack.empty()) {
+				values++;
+				state = State::VALUE;
+				need_space = scalar;
+				if constexpr (push_detail::HasEndValue<Handler>::value)
+					handler.EndValue();
+			}
+			else {
+				stack.back().count++;
+				state = State::AFTER_VALUE;
+			}
+		}
+
+		void Close(char c, const char* at)
+		{
+			const char open = c == '}' ? '{' : '[';
+			if (stack.empty() || stack.back().open != open)
+				Fail("괄호 짝이 맞지 않습니다", at);
+			const size_t count = stack.back().count;
+			stack.pop_back();
+			if (open == '{')
+				handler.EndObject(count);
+			else
+				handler.EndArray(count);
+			EndValue(false);
+		}
+
+		//값의 첫 문자. 숫자와 리터럴은 첫 문자를 소비하지 않음
+		const char* StartValue(const char* p)
+		{
+			switch (*p) {
+			case '{':
+				stack.push_back(Frame{ '{', 0 });
+				state = State::FIRST_KEY;
+				handler.StartObject();
+				return p + 1;
+			case '[':
+				stack.push_back(Frame{ '[', 0 });
+				state = State::FIRST_ELEMENT;
+				handler.StartArray();
+				return p + 1;
+			case '"':
+				token.clear();
+				key = false;
+				state = State::STRING;
+				return p + 1;
+			case 't':
+				literal = "true";
+				break;
+			case 'f':
+				literal = "false";
+				break;
+			case 'n':
+				literal = "null";
+				break;
+			default:
+				if (*p != '-' && !(*p >= '0' && *p <= '9'))
+					Fail("인식 불가", p);
+				token.clear();
+				state = State::NUMBER;
+				return p;
+			}
+			literal_pos = 0;
+			state = State::LITERAL;
+			return p;
+		}
+
+		void EndNumber(const char* at)
+		{
+			number_detail::Number n;
+			const char* const bg = token.data();
+			const char* const end = bg + token.size();
+			if (!number_detail::IsStrict(bg, end) || !number_detail::Convert(bg, end, n))
+				Fail("숫자 형식 오류", at);
+
+			switch (n.kind) {
+			case JNumber::KIND::INT:
+				handler.Number(n.i);
+				break;
+			case JNumber::KIND::UINT:
+				handler.Number(n.u);
+				break;
+			default:
+				handler.Number(n.f);
+			}
+			EndValue();
+		}
+
+		void EndLiteral()
+		{
+			if (literal[0] == 'n')
+				handler.Null();
+			else
+				handler.Bool(literal[0] == 't');
+			EndValue();
+		}
+
+		//닫는 따옴표를 만나면 이벤트를 보내고 그 다음 위치를 반환
+		const char* ScanString(const char* p, const char* last)
+		{
+			while (p != last) {
+				if (escape == 0) {
+					const char* q = p;
+					while (q != last && *q != '"' && *q != '\\' && static_cast<unsigned char>(*q) >= 0x20)
+						++q;
+					token.append(p, q - p);
+					p = q;
+					if (p == last)
+						break;
+					if (static_cast<unsigned char>(*p) < 0x20)
+						Fail("문자열에 제어 문자가 있습니다", p);
+					if (*p++ == '\\') {
+						escape = 1;
+						continue;
+					}
+
+					if (key) {
+						handler.Key(std::string_view(token));
+						state = State::COLON;
+					}
+					else {
+						handler.String(std::string_view(token));
+						EndValue();
+					}
+					return p;
+				}
+
+				const char c = *p++;
+				if (escape == 1) {
+					escape = 0;
+					switch (c) {
+					case 'u':
+						escape = 2;
+						continue;
+					case 'b':
+						token += '\b';
+						break;
+					case 'f':
+						token += '\f';
+						break;
+					case 'n':
+						token += '\n';
+						break;
+					case 'r':
+						token += '\r';
+						break;
+					case 't':
+						token += '\t';
+						break;
+					case '"':
+					case '\\':
+					case '/':
+						token += c;
+						break;
+					default:
+						Fail("잘못된 이스케이프", p - 1);
+					}
+					continue;
+				}
+
+				if (!isxdigit(static_cast<unsigned char>(c)))
+					Fail("\\u 뒤에는 16진수 4자리가 와야 합니다", p - 1);
+				hex[escape - 2] = c; //JString::ParseStringInto와 같은 방식으로 변환
+				if (++escape == 6) {
+					escape = 0;
+					const wchar_t wc = static_cast<wchar_t>(::strtol(hex, NULL, 16));
+					char buff[MB_LEN_MAX];
+					const int n = wctomb(buff, wc);
+					if (n == -1)
+						Fail("setlocale(LC_CTYPE, \"\")", p);
+					token.append(buff, n);
+				}
+			}
+			return p;
+		}
+	public:
+		explicit JPushParser(Handler& handler) : handler(handler) {}
+		JPushParser(const JPushParser&) = delete;
+
+		void feed(const char* data, size_t size)
+		{
+			const char* p = data;
+			const char* const last = data + size;
+			chunk = data;
+
+			while (p != last) {
+				switch (state) {
+				case State::STRING:
+					p = ScanString(p, last);
+					continue;
+				case State::NUMBER:
+					while (p != last && push_detail::IsNumberChar(*p))
+						token += *p++;
+					if (p != last) //숫자 뒤의 문자는 다음 상태가 읽음
+						EndNumber(p);
+					continue;
+				case State::LITERAL:
+					while (p != last && literal[literal_pos] != '\0') {
+						if (*p != literal[literal_pos])
+							Fail("매칭되는 리터럴 없음", p);
+						++p;
+						++literal_pos;
+					}
+					if (literal[literal_pos] == '\0')
+						EndLiteral();
+					continue;
+				default:
+					break;
+				}
+
+				const char c = *p;
+				if (simd_detail::IsSpace(static_cast<unsigned char>(c))) {
+					need_space = false;
+					++p;
+					continue;
+				}
+				if (need_space)
+					Fail("값 사이에 공백이 없습니다", p);
+
+				switch (state) {
+				case State::FIRST_ELEMENT:
+					if (c == ']') {
+						Close(c, p++);
+						break;
+					}
+					p = StartValue(p);
+					break;
+				case State::VALUE:
+					p = StartValue(p);
+					break;
+				case State::FIRST_KEY:
+					if (c == '}') {
+						Close(c, p++);
+						break;
+					}
+					[[fallthrough]];
+				case State::KEY:
+					if (c != '"')
+						Fail("키는 \"로 시작해야 합니다", p);
+					++p;
+					token.clear();
+					key = true;
+					state = State::STRING;
+					break;
+				case State::COLON:
+					if (c != ':')
+						Fail("':' 없음", p);
+					++p;
+					state = State::VALUE;
+					break;
+				case State::AFTER_VALUE:
+					if (c == ',') {
+						++p;
+						state = stack.back().open == '{' ? State::KEY : State::VALUE;
+					}
+					else if (c == '}' || c == ']') {
+						Close(c, p++);
+					}
+					else {
+						Fail(stack.back().open == '{' ? "콤마 없이 다음 값을 읽을 수 없습니다" : "불완전한 배열", p);
+					}
+					break;
+				default:
+					break;
+				}
+			}
+			offset += size;
+		}
+
+		void feed(std::string_view data)
+		{
+			feed(data.data(), data.size());
+		}
+
+		//입력 끝. 끝에 걸린 최상위 숫자를 마무리하고, 값이 끝나지 않았으면 예외
+		void finish()
+		{
+			chunk = nullptr; //오류 위치는 입력 끝
+			if (state == State::NUMBER)
+				EndNumber(chunk);
+			if (state != State::VALUE || !stack.empty())
+				Fail("비정상적 스트림 종료", chunk);
+		}
+
+		//지금까지 끝난 최상위 값의 수
+		size_t Values() const noexcept { return values; }
+
+		//최상위 값을 읽는 중인지
+		bool InValue() const noexcept { return state != State::VALUE || !stack.empty(); }
+	};
+
+	//조각 입력에서 최상위 값이 끝날 때마다 트리를 만들어 callback(JValue*)에 넘김. callback이 값의 소유권을 가짐
+	template <typename Callback>
+	class JPushBuilder {
+		struct Sink {
+			JDomBuilder builder;
+			Callback callback;
+
+			Sink(Callback&& callback, std::pmr::memory_resource* mr, KeyPool* keys)
+				: builder(mr, keys), callback(std::move(callback)) {}
+
+			void StartObject() { builder.StartObject(); }
+			void Key(std::string_view k) { builder.Key(k); }
+			void EndObject(size_t n) { builder.EndObject(n); }
+			void StartArray() { builder.StartArray(); }
+			void EndArray(size_t n) { builder.EndArray(n); }
+			void String(std::string_view s) { builder.String(s); }
+			void Number(int64_t v) { builder.Number(v); }
+			void Number(uint64_t v) { builder.Number(v); }
+			void Number(JFloat v) { builder.Number(v); }
+			void Bool(bool b) { builder.Bool(b); }
+			void Null() { builder.Null(); }
+			void EndValue() { callback(builder.Take()); }
+		};
+
+		Sink sink;
+		JPushParser<Sink> parser;
+	public:
+		explicit JPushBuilder(Callback callback, std::pmr::memory_resource* mr = nullptr, KeyPool* keys = nullptr)
+			: sink(std::move(callback), mr, keys), parser(sink) {}
+
+		void feed(const char* data, size_t size) { parser.feed(data, size); }
+		void feed(std::string_view data) { parser.feed(data); }
+		void finish() { parser.finish(); }
+		size_t Values() const noexcept { return parser.Values(); }
+		bool InValue() const noexcept { return parser.InValue(); }
+	};
+}
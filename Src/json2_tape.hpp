@@ -0,0 +1,695 @@
+#pragma once
+#include "json2.hpp"
+#include <cstdint>
+#include <iterator>
+
+namespace namespace_json_2 {
+	//연속된 64비트 엔트리 배열로 표현한 읽기 전용 문서
+	//엔트리 = 상위 8비트 태그 + 하위 56비트 값
+	//  '{' '[' : 짝이 되는 닫는 엔트리의 위치 (O(1) 건너뛰기)
+	//  '}' ']' : 원소(멤버) 개수
+	//  '"'     : 문자열 버퍼 오프셋 ([uint32 길이][바이트])
+	//  'l' 'u' 'd' : 다음 엔트리에 int64 / uint64 / double 원본 비트 ('u'는 int64 범위를 넘는 양수)
+	//  't' 'f' 'n' : 리터럴
+	//객체 멤버는 키('"') 다음에 값이 오는 순서로 저장됨
+	namespace tape_detail {
+		constexpr uint64_t payload_mask = (uint64_t(1) << 56) - 1;
+
+		inline uint64_t Entry(char tag, uint64_t payload) noexcept
+		{
+			return (uint64_t(static_cast<unsigned char>(tag)) << 56) | (payload & payload_mask);
+		}
+
+		inline char Tag(uint64_t e) noexcept
+		{
+			return static_cast<char>(e >> 56);
+		}
+
+		inline uint64_t Payload(uint64_t e) noexcept
+		{
+			return e & payload_mask;
+		}
+
+		//스냅숏 = 헤더 + 엔트리 배열 + 문자열 버퍼. 모든 위치가 오프셋이므로 어느 주소에 올려도 그대로 읽힘
+		struct SnapshotHeader {
+			char magic[8];
+			uint64_t byte_order; //만든 기계와 바이트 순서가 다르면 읽지 않음
+			uint64_t tape_size; //엔트리 수
+			uint64_t strings_size;
+		};
+
+		constexpr char snapshot_magic[8] = { 'J', '2', 'T', 'A', 'P', 'E', 0, 1 }; //마지막 바이트는 형식 버전
+		constexpr uint64_t byte_order_mark = 0x0102030405060708ull;
+
+		inline SnapshotHeader MakeHeader(size_t tape_size, size_t strings_size) noexcept
+		{
+			SnapshotHeader h;
+			memcpy(h.magic, snapshot_magic, sizeof(h.magic));
+			h.byte_order = byte_order_mark;
+			h.tape_size = tape_size;
+			h.strings_size = strings_size;
+			return h;
+		}
+	}
+
+	class TapeRef;
+
+	class Tape {
+		std::vector<uint64_t> tape;
+		std::string strings;
+
+		void Put(char tag, uint64_t payload = 0)
+		{
+			tape.push_back(tape_detail::Entry(tag, payload));
+		}
+
+		void ParseValue(JBuffer& is);
+		void ParseString(JBuffer& is);
+		void ParseNumber(JBuffer& is);
+		void ParseLiteral(JBuffer& is);
+		void ParseArray(JBuffer& is);
+		void ParseObject(JBuffer& is);
+	public:
+		Tape() = default;
+		Tape(Tape&&) = default;
+		Tape& operator=(Tape&&) = default;
+
+		//엄격한 JSON만 허용 (큰따옴표 문자열, 따옴표로 감싼 키)
+		static Tape Parse(std::string_view str, const StructuralIndex* index = nullptr);
+
+		TapeRef Root() const noexcept;
+		size_t TapeSize() const noexcept { return tape.size(); }
+		size_t StringsSize() const noexcept { return strings.size(); }
+
+		//TapeView::Open으로 다시 읽을 수 있는 스냅숏을 씀
+		void SaveSnapshot(std::string& out) const;
+		void SaveSnapshot(std::ostream& os) const;
+	};
+
+	class TapeRef {
+		const uint64_t* tape;
+		const char* strings;
+		size_t idx;
+
+		uint64_t entry() const noexcept { return tape[idx]; }
+		char tag() const noexcept { return tape_detail::Tag(tape[idx]); }
+		bool container() const noexcept { return tag() == '{' || tag() == '['; }
+
+		//원소 또는 멤버 구간의 끝(닫는 엔트리 위치). 컨테이너가 아니면 빈 구간이 되도록 idx + 1
+		size_t last() const noexcept
+		{
+			return container() ? static_cast<size_t>(tape_detail::Payload(entry())) : idx + 1;
+		}
+
+		//현재 값 다음 엔트리의 위치
+		static size_t Next(const uint64_t* tape, size_t i) noexcept
+		{
+			switch (tape_detail::Tag(tape[i])) {
+			case '{':
+			case '[':
+				return static_cast<size_t>(tape_detail::Payload(tape[i])) + 1;
+			case 'l':
+			case 'u':
+			case 'd':
+				return i + 2;
+			default:
+				return i + 1;
+			}
+		}
+
+		std::string_view StringAt(size_t i) const noexcept
+		{
+			const char* p = strings + tape_detail::Payload(tape[i]);
+			uint32_t len;
+			memcpy(&len, p, sizeof(len));
+			return std::string_view(p + sizeof(len), len);
+		}
+	public:
+		TapeRef(const uint64_t* tape, const char* strings, size_t idx) noexcept : tape(tape), strings(strings), idx(idx) {}
+
+		VALUE_TYPE type() const noexcept
+		{
+			switch (tag()) {
+			case '{':
+				return VALUE_TYPE::OBJECT;
+			case '[':
+				return VALUE_TYPE::ARRAY;
+			case '"':
+				return VALUE_TYPE::STRING;
+			case 'l':
+			case 'u':
+			case 'd':
+				return VALUE_TYPE::NUMBER;
+			default:
+				return VALUE_TYPE::JLITERAL;
+			}
+		}
+
+		bool IsNull() const noexcept { return tag() == 'n'; }
+		bool Bool() const noexcept { return tag() == 't'; }
+		bool IsFloat() const noexcept { return tag() == 'd'; }
+
+		int64_t asInt64() const noexcept
+		{
+			if (tag() == 'd')
+				return static_cast<int64_t>(asFloat());
+			return static_cast<int64_t>(tape[idx + 1]);
+		}
+
+		uint64_t asUInt64() const noexcept
+		{
+			if (tag() == 'd')
+				return static_cast<uint64_t>(asFloat());
+			return tape[idx + 1];
+		}
+
+		int asInt() const noexcept
+		{
+			return static_cast<int>(asInt64());
+		}
+
+		JFloat asFloat() const noexcept
+		{
+			if (tag() == 'l')
+				return static_cast<JFloat>(static_cast<int64_t>(tape[idx + 1]));
+			if (tag() == 'u')
+				return static_cast<JFloat>(tape[idx + 1]);
+			JFloat d;
+			memcpy(&d, &tape[idx + 1], sizeof(d));
+			return d;
+		}
+
+		std::string_view str() const noexcept
+		{
+			return StringAt(idx);
+		}
+
+		//배열 원소 수 또는 객체 멤버 수. 컨테이너가 아니면 0
+		size_t size() const noexcept
+		{
+			if (!container())
+				return 0;
+			return static_cast<size_t>(tape_detail::Payload(tape[tape_detail::Payload(entry())]));
+		}
+
+		bool empty() const noexcept
+		{
+			return size() == 0;
+		}
+
+		bool Has(std::string_view key) const noexcept
+		{
+			if (tag() != '{')
+				return false;
+			const size_t end = static_cast<size_t>(tape_detail::Payload(entry()));
+			for (size_t i = idx + 1; i < end; i = Next(tape, i + 1)) {
+				if (StringAt(i) == key)
+					return true;
+			}
+			return false;
+		}
+
+		//중복 키는 트리처럼 마지막 값
+		TapeRef at(std::string_view key) const
+		{
+			if (tag() != '{')
+				throw std::out_of_range("객체가 아닙니다");
+			const size_t end = static_cast<size_t>(tape_detail::Payload(entry()));
+			size_t found = 0;
+			for (size_t i = idx + 1; i < end; i = Next(tape, i + 1)) {
+				if (StringAt(i) == key)
+					found = i + 1;
+			}
+			if (found == 0)
+				throw std::out_of_range("키가 없습니다");
+			return TapeRef(tape, strings, found);
+		}
+
+		TapeRef at(size_t n) const
+		{
+			if (tag() != '[')
+				throw std::out_of_range("배열이 아닙니다");
+			const size_t end = static_cast<size_t>(tape_detail::Payload(entry()));
+			size_t i = idx + 1;
+			for (; i < end && n > 0; n--)
+				i = Next(tape, i);
+			if (i >= end)
+				throw std::out_of_range("배열 범위를 벗어났습니다");
+			return TapeRef(tape, strings, i);
+		}
+
+		TapeRef operator[](std::string_view key) const { return at(key); }
+		TapeRef operator[](const char* key) const { return at(std::string_view(key)); }
+		TapeRef operator[](size_t n) const { return at(n); }
+
+		class iterator {
+			const uint64_t* tape;
+			const char* strings;
+			size_t i;
+			bool object;
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = TapeRef;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = TapeRef;
+
+			iterator(const uint64_t* tape, const char* strings, size_t i, bool object) noexcept
+				: tape(tape), strings(strings), i(i), object(object) {}
+
+			//객체의 경우 값, 키는 key()로 얻음
+			TapeRef operator*() const noexcept
+			{
+				return TapeRef(tape, strings, object ? i + 1 : i);
+			}
+
+			std::string_view key() const noexcept
+			{
+				return TapeRef(tape, strings, i).str();
+			}
+
+			iterator& operator++() noexcept
+			{
+				i = Next(tape, object ? i + 1 : i);
+				return *this;
+			}
+
+			bool operator==(const iterator& o) const noexcept { return i == o.i; }
+			bool operator!=(const iterator& o) const noexcept { return i != o.i; }
+		};
+
+		//컨테이너가 아니면 빈 구간
+		iterator begin() const noexcept { return iterator(tape, strings, idx + 1, tag() == '{'); }
+		iterator end() const noexcept { return iterator(tape, strings, last(), tag() == '{'); }
+
+		void Write(JWriter& w) const
+		{
+			switch (tag()) {
+			case '{': {
+				if (empty()) {
+					w.Raw("{}");
+					return;
+				}
+				auto it = begin(), e = end();
+				w.Raw('{');
+				w.String(it.key());
+				w.Raw(':');
+				(*it).Write(w);
+				for (++it; it != e; ++it) {
+					w.Raw(", ");
+					w.String(it.key());
+					w.Raw(':');
+					(*it).Write(w);
+				}
+				w.Raw('}');
+				return;
+			}
+			case '[': {
+				if (empty()) {
+					w.Raw("[]");
+					return;
+				}
+				auto it = begin(), e = end();
+				w.Raw('[');
+				(*it).Write(w);
+				for (++it; it != e; ++it) {
+					w.Raw(", ");
+					(*it).Write(w);
+				}
+				w.Raw(']');
+				return;
+			}
+			case '"':
+				return w.String(str());
+			case 'l':
+				return w.Number(asInt64());
+			case 'u':
+				return w.Number(asUInt64());
+			case 'd':
+				return w.Number(asFloat());
+			case 't':
+				return w.Raw("true");
+			case 'f':
+				return w.Raw("false");
+			default:
+				return w.Raw("null");
+			}
+		}
+
+		std::string to_string() const
+		{
+			std::string out;
+			JWriter w(out);
+			Write(w);
+			return out;
+		}
+
+		std::ostream& Repr(std::ostream& os) const
+		{
+			const std::string s = to_string();
+			return os.write(s.data(), s.size());
+		}
+	};
+
+	inline std::ostream& operator<<(std::ostream& os, const TapeRef& v) {
+		return v.Repr(os);
+	}
+
+	//스냅숏을 복사하지 않고 그 자리에서 읽는 뷰. 파일을 mmap한 메모리를 그대로 넘기면 파싱 없이 바로 조회할 수 있음
+	//data는 8바이트 정렬이어야 하고 뷰와 TapeRef를 쓰는 동안 유효해야 함
+	//Open은 헤더와 크기만 확인함. 믿을 수 없는 파일은 Validate로 엔트리까지 검사
+	class TapeView {
+		const uint64_t* tape = nullptr;
+		size_t tape_size = 0;
+		const char* strings = nullptr;
+		size_t strings_size = 0;
+	public:
+		TapeView() = default;
+
+		static TapeView Open(const void* data, size_t size)
+		{
+			using tape_detail::SnapshotHeader;
+			if (reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) != 0)
+				throw std::invalid_argument("스냅숏이 8바이트 정렬이 아닙니다");
+			if (size < sizeof(SnapshotHeader))
+				throw std::invalid_argument("스냅숏이 너무 짧습니다");
+
+			SnapshotHeader h;
+			memcpy(&h, data, sizeof(h));
+			if (memcmp(h.magic, tape_detail::snapshot_magic, sizeof(h.magic)) != 0)
+				throw std::invalid_argument("스냅숏 형식이 아닙니다");
+			if (h.byte_order != tape_detail::byte_order_mark)
+				throw std::invalid_argument("바이트 순서가 다른 스냅숏입니다");
+			const uint64_t body = size - sizeof(SnapshotHeader);
+			if (h.tape_size == 0 || h.tape_size > body / sizeof(uint64_t) || h.strings_size != body - h.tape_size * sizeof(uint64_t))
+				throw std::invalid_argument("스냅숏 크기가 맞지 않습니다");
+
+			TapeView v;
+			v.tape = reinterpret_cast<const uint64_t*>(static_cast<const char*>(data) + sizeof(SnapshotHeader));
+			v.tape_size = static_cast<size_t>(h.tape_size);
+			v.strings = reinterpret_cast<const char*>(v.tape + v.tape_size);
+			v.strings_size = static_cast<size_t>(h.strings_size);
+			return v;
+		}
+
+		static TapeView Open(std::string_view snapshot)
+		{
+			return Open(snapshot.data(), snapshot.size());
+		}
+
+		TapeRef Root() const noexcept
+		{
+			return TapeRef(tape, strings, 0);
+		}
+
+		size_t TapeSize() const noexcept { return tape_size; }
+		size_t StringsSize() const noexcept { return strings_size; }
+
+		//모든 엔트리의 태그, 괄호 짝, 원소 개수, 문자열 범위와 객체 키 자리를 확인. 손상된 스냅숏이면 false
+		bool Validate() const
+		{
+			struct Frame {
+				size_t pos; //'{' '['의 위치
+				bool object;
+				bool key; //객체에서 다음 엔트리가 키 자리인지
+				uint64_t count;
+			};
+			std::vector<Frame> open; //아직 닫히지 않은 괄호
+
+			const auto ValidString = [this](uint64_t payload) {
+				uint32_t len;
+				if (payload > strings_size || strings_size - payload < sizeof(len))
+					return false;
+				memcpy(&len, strings + payload, sizeof(len));
+				return strings_size - payload - sizeof(len) >= len;
+			};
+
+			//값 하나가 끝남
+			const auto EndValue = [&open]() {
+				if (!open.empty()) {
+					open.back().count++;
+					open.back().key = open.back().object;
+				}
+			};
+
+			for (size_t i = 0; i < tape_size; i++) {
+				const uint64_t e = tape[i];
+				const uint64_t payload = tape_detail::Payload(e);
+				const char tag = tape_detail::Tag(e);
+
+				if (!open.empty() && open.back().key && tag != '}') { //키는 범위 안의 문자열이어야 함
+					if (tag != '"' || !ValidString(payload))
+						return false;
+					open.back().key = false;
+					continue;
+				}
+
+				switch (tag) {
+				case '{':
+				case '[':
+					if (payload <= i || payload >= tape_size)
+						return false;
+					open.push_back(Frame{ i, tag == '{', tag == '{', 0 });
+					continue;
+				case '}':
+				case ']': {
+					if (open.empty())
+						return false;
+					const Frame f = open.back();
+					const uint64_t o = tape[f.pos];
+					if (tape_detail::Payload(o) != i || f.object != (tag == '}'))
+						return false;
+					if ((f.object && !f.key) || payload != f.count) //키만 있고 값이 없거나 개수가 다름
+						return false;
+					open.pop_back();
+					break;
+				}
+				case '"':
+					if (!ValidString(payload))
+						return false;
+					break;
+				case 'l':
+				case 'u':
+				case 'd':
+					if (++i >= tape_size)
+						return false;
+					break;
+				case 't':
+				case 'f':
+				case 'n':
+					break;
+				default:
+					return false;
+				}
+				EndValue();
+				if (open.empty() && i + 1 != tape_size) //루트 값 뒤에 엔트리가 남음
+					return false;
+			}
+			return open.empty();
+		}
+	};
+
+	inline TapeRef Tape::Root() const noexcept
+	{
+		return TapeRef(tape.data(), strings.data(), 0);
+	}
+
+	inline void Tape::SaveSnapshot(std::string& out) const
+	{
+		const auto h = tape_detail::MakeHeader(tape.size(), strings.size());
+
+		out.reserve(out.size() + sizeof(h) + tape.size() * sizeof(uint64_t) + strings.size());
+		out.append(reinterpret_cast<const char*>(&h), sizeof(h));
+		out.append(reinterpret_cast<const char*>(tape.data()), tape.size() * sizeof(uint64_t));
+		out.append(strings);
+	}
+
+	inline void Tape::SaveSnapshot(std::ostream& os) const
+	{
+		const auto h = tape_detail::MakeHeader(tape.size(), strings.size());
+
+		os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+		os.write(reinterpret_cast<const char*>(tape.data()), static_cast<std::streamsize>(tape.size() * sizeof(uint64_t)));
+		os.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+	}
+
+	inline Tape Tape::Parse(std::string_view str, const StructuralIndex* index)
+	{
+		Tape t;
+		t.tape.reserve(str.size() / 8 + 16);
+		t.strings.reserve(str.size() / 2 + 16);
+		JBuffer is(str, index);
+		t.ParseValue(is);
+		ExpectEnd<StrictPolicy>(is);
+		return t;
+	}
+
+	inline void Tape::ParseValue(JBuffer& is)
+	{
+		const char c = ReadSkipSpaces(is); is.unget();
+		switch (c) {
+		case '"':
+			ParseString(is);
+			break;
+		case '[':
+			ParseArray(is);
+			break;
+		case '{':
+			ParseObject(is);
+			break;
+		case '-':
+			ParseNumber(is);
+			break;
+		default:
+			if (std::isdigit(static_cast<unsigned char>(c)))
+				ParseNumber(is);
+			else if (std::isalpha(static_cast<unsigned char>(c)))
+				ParseLiteral(is);
+			else
+				throw JSONLIB_THROW_ERROR("인식 불가");
+		}
+	}
+
+	inline void Tape::ParseString(JBuffer& is)
+	{
+		if (is.peek() != '"')
+			throw JSONLIB_THROW_ERROR("문자열은 반드시 \"로 시작해야 합니다");
+		const size_t offset = strings.size();
+		uint32_t len = 0;
+		strings.append(reinterpret_cast<const char*>(&len), sizeof(len));
+		JString::ParseStringInto<StrictPolicy>(is, strings);
+		len = static_cast<uint32_t>(strings.size() - offset - sizeof(len));
+		memcpy(&strings[offset], &len, sizeof(len));
+		Put('"', offset);
+	}
+
+	inline void Tape::ParseNumber(JBuffer& is)
+	{
+		const char* const bg = is.data();
+		const char* const end = number_detail::Scan(bg, bg + is.remaining());
+		number_detail::Number n;
+		if (!number_detail::IsStrict(bg, end) || !number_detail::Convert(bg, end, n))
+			throw JSONLIB_THROW_ERROR("숫자 형식 오류");
+
+		uint64_t raw;
+		switch (n.kind) {
+		case JNumber::KIND::INT:
+			Put('l');
+			raw = static_cast<uint64_t>(n.i);
+			break;
+		case JNumber::KIND::UINT:
+			Put('u');
+			raw = n.u;
+			break;
+		default:
+			Put('d');
+			memcpy(&raw, &n.f, sizeof(raw));
+		}
+		tape.push_back(raw);
+		is.skip(end - bg);
+	}
+
+	inline void Tape::ParseLiteral(JBuffer& is)
+	{
+		const std::string_view rest(is.data(), is.remaining());
+		char tag;
+		size_t len;
+		if (rest.compare(0, 4, "true") == 0) {
+			tag = 't';
+			len = 4;
+		}
+		else if (rest.compare(0, 5, "false") == 0) {
+			tag = 'f';
+			len = 5;
+		}
+		else if (rest.compare(0, 4, "null") == 0) {
+			tag = 'n';
+			len = 4;
+		}
+		else {
+			throw JSONLIB_THROW_ERROR("매칭되는 리터럴 없음");
+		}
+
+		if (len < rest.size()) { //truex처럼 리터럴 뒤에 바로 다른 문자가 붙으면 오류
+			const char next = rest[len];
+			if (!simd_detail::IsSpace(static_cast<unsigned char>(next)) && next != ',' && next != ']' && next != '}')
+				throw JSONLIB_THROW_ERROR("매칭되는 리터럴 없음");
+		}
+		Put(tag);
+		is.skip(len);
+	}
+
+	inline void Tape::ParseArray(JBuffer& is)
+	{
+		const size_t open = tape.size();
+		Put('[');
+		is.get();
+
+		size_t count = 0;
+		if (ReadSkipSpaces(is) != ']') {
+			is.unget();
+			while (true) {
+				ParseValue(is);
+				count++;
+				const char c = ReadSkipSpaces(is);
+				if (c == ']')
+					break;
+				else if (c != ',')
+					throw JSONLIB_THROW_ERROR("불완전한 배열");
+			}
+		}
+
+		tape[open] = tape_detail::Entry('[', tape.size());
+		Put(']', count);
+	}
+
+	inline void Tape::ParseObject(JBuffer& is)
+	{
+		const size_t open = tape.size();
+		Put('{');
+		is.get();
+
+		size_t count = 0;
+		if (ReadSkipSpaces(is) != '}') {
+			is.unget();
+			while (true) {
+				SkipSpaces(is);
+				ParseString(is);
+				if (ReadSkipSpaces(is) != ':')
+					throw JSONLIB_THROW_ERROR("':' 없음");
+				ParseValue(is);
+				count++;
+				const char c = ReadSkipSpaces(is);
+				if (c == '}')
+					break;
+				else if (c != ',')
+					throw JSONLIB_THROW_ERROR("콤마 없이 다음 값을 읽을 수 없습니다");
+			}
+		}
+
+		tape[open] = tape_detail::Entry('{', tape.size());
+		Put('}', count);
+	}
+
+	inline TapeRef find(const TapeRef& org, const CompiledPath& path) {
+		TapeRef cur = org;
+		for (const auto& step : path.Steps()) {
+			if (cur.type() == VALUE_TYPE::OBJECT)
+				cur = cur.at(step.key);
+			else if (cur.type() == VALUE_TYPE::ARRAY) {
+				if (step.index == CompiledPath::npos)
+					throw std::invalid_argument("배열 인덱스가 숫자가 아닙니다");
+				cur = cur.at(step.index);
+			}
+			else {
+				break;
+			}
+		}
+
+		return cur;
+	}
+
+	inline TapeRef find(const TapeRef& org, const std::string& select, char delim = '.') {
+		return find(org, *CompiledPath::Cached(select, delim));
+	}
+}
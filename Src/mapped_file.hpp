@@ -0,0 +1,214 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace namespace_json_2 {
+	//파일 전체를 메모리에 매핑. 순차 읽기 힌트를 주므로 처음부터 끝까지 한 번 읽는 파서에 맞음
+	//ReadOnly: 읽기 전용. json2 파서는 끝을 넘어 읽지 않으므로 그대로 넘기면 됨
+	//CopyOnWrite: 쓰기 가능한 개인 사본(파일에는 반영되지 않음)이고 data()[size()]가 '\0'
+	//  '\0'으로 끝나는 버퍼를 제자리에서 고치는 파서(json.cpp)용. 마지막 페이지의 남는 부분이 0으로 채워지는 것을 이용하며
+	//  파일 크기가 페이지 크기의 배수이면 남는 부분이 없으므로 힙에 읽어 들임
+	class MappedFile {
+	public:
+		enum class Mode {
+			ReadOnly,
+			CopyOnWrite,
+		};
+	private:
+		char* ptr = nullptr;
+		size_t len = 0;
+		bool heap = false; //매핑 대신 new[]로 읽음
+
+		[[noreturn]] static void Fail(const char* what, const std::string& path)
+		{
+			std::string msg = what;
+			msg += ": ";
+			msg += path;
+			msg += " (";
+#ifdef _WIN32
+			msg += std::to_string(GetLastError());
+#else
+			msg += std::to_string(errno);
+#endif
+			msg += ')';
+			throw std::runtime_error(msg);
+		}
+
+		void Release() noexcept
+		{
+			if (heap) {
+				delete[] ptr;
+			}
+			else if (ptr != nullptr) {
+#ifdef _WIN32
+				UnmapViewOfFile(ptr);
+#else
+				munmap(ptr, len);
+#endif
+			}
+			ptr = nullptr;
+			len = 0;
+			heap = false;
+		}
+
+#ifdef _WIN32
+		void ReadToHeap(HANDLE file, const std::string& path)
+		{
+			ptr = new char[len + 1];
+			heap = true;
+			size_t done = 0;
+			while (done < len) {
+				const DWORD chunk = static_cast<DWORD>(std::min<size_t>(len - done, 1u << 30));
+				DWORD got = 0;
+				if (!ReadFile(file, ptr + done, chunk, &got, nullptr) || got == 0)
+					Fail("파일을 읽을 수 없습니다", path);
+				done += got;
+			}
+			ptr[len] = '\0';
+		}
+
+		void Open(const std::string& path, Mode mode)
+		{
+			HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				Fail("파일을 열 수 없습니다", path);
+
+			try {
+				LARGE_INTEGER size;
+				if (!GetFileSizeEx(file, &size))
+					Fail("파일 크기를 알 수 없습니다", path);
+				if (static_cast<unsigned long long>(size.QuadPart) >= SIZE_MAX)
+					Fail("파일이 너무 큽니다", path);
+				len = static_cast<size_t>(size.QuadPart);
+
+				SYSTEM_INFO info;
+				GetSystemInfo(&info);
+				if (len == 0 || (mode == Mode::CopyOnWrite && len % info.dwPageSize == 0)) { //빈 파일은 매핑할 수 없음
+					if (mode == Mode::CopyOnWrite)
+						ReadToHeap(file, path);
+				}
+				else {
+					const bool cow = mode == Mode::CopyOnWrite;
+					HANDLE mapping = CreateFileMappingA(file, nullptr, cow ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+					if (mapping == nullptr)
+						Fail("파일을 매핑할 수 없습니다", path);
+					ptr = static_cast<char*>(MapViewOfFile(mapping, cow ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+					CloseHandle(mapping); //뷰가 매핑을 유지함
+					if (ptr == nullptr)
+						Fail("파일을 매핑할 수 없습니다", path);
+				}
+			}
+			catch (...) {
+				CloseHandle(file);
+				Release();
+				throw;
+			}
+			CloseHandle(file);
+		}
+#else
+		void ReadToHeap(int fd, const std::string& path)
+		{
+			ptr = new char[len + 1];
+			heap = true;
+			size_t done = 0;
+			while (done < len) {
+				const ssize_t got = pread(fd, ptr + done, len - done, static_cast<off_t>(done));
+				if (got < 0 && errno == EINTR)
+					continue;
+				if (got <= 0)
+					Fail("파일을 읽을 수 없습니다", path);
+				done += static_cast<size_t>(got);
+			}
+			ptr[len] = '\0';
+		}
+
+		void Open(const std::string& path, Mode mode)
+		{
+			const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0)
+				Fail("파일을 열 수 없습니다", path);
+
+			try {
+				struct stat st;
+				if (fstat(fd, &st) != 0)
+					Fail("파일 크기를 알 수 없습니다", path);
+				len = static_cast<size_t>(st.st_size);
+
+				const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+				if (len == 0 || (mode == Mode::CopyOnWrite && len % page == 0)) {
+					if (mode == Mode::CopyOnWrite)
+						ReadToHeap(fd, path);
+				}
+				else {
+					const int prot = mode == Mode::CopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+					void* p = mmap(nullptr, len, prot, MAP_PRIVATE, fd, 0);
+					if (p == MAP_FAILED)
+						Fail("파일을 매핑할 수 없습니다", path);
+					ptr = static_cast<char*>(p);
+					madvise(p, len, MADV_SEQUENTIAL);
+				}
+			}
+			catch (...) {
+				::close(fd);
+				Release();
+				throw;
+			}
+			::close(fd); //매핑은 파일을 닫아도 유지됨
+		}
+#endif
+	public:
+		explicit MappedFile(const std::string& path, Mode mode = Mode::ReadOnly)
+		{
+			Open(path, mode);
+		}
+
+		MappedFile(MappedFile&& o) noexcept
+			: ptr(std::exchange(o.ptr, nullptr)), len(std::exchange(o.len, 0)), heap(std::exchange(o.heap, false)) {}
+
+		MappedFile& operator=(MappedFile&& o) noexcept
+		{
+			if (this != &o) {
+				Release();
+				ptr = std::exchange(o.ptr, nullptr);
+				len = std::exchange(o.len, 0);
+				heap = std::exchange(o.heap, false);
+			}
+			return *this;
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile()
+		{
+			Release();
+		}
+
+		//ReadOnly로 연 빈 파일은 nullptr
+		char* data() noexcept { return ptr; }
+		const char* data() const noexcept { return ptr; }
+		size_t size() const noexcept { return len; }
+		std::string_view view() const noexcept { return std::string_view(ptr, len); }
+	};
+}
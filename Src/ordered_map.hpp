@@ -0,0 +1,200 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string_view>
+#include <utility>
+#include <memory>
+#include <functional>
+
+namespace namespace_json_2 {
+	//삽입 순서를 유지하는 평탄한 문자열 키 맵. 원소는 vector에 순서대로 저장됨
+	//원소가 index_threshold 이하이면 앞에서부터 비교하고, 넘으면 개방 주소법(선형 탐사) 해시 색인을 만듦
+	//Key는 std::string_view로 변환 가능해야 함 (std::string, std::pmr::string, std::string_view)
+	template <typename Key, typename T, typename Alloc = std::allocator<std::pair<Key, T>>>
+	class OrderedMap {
+	public:
+		using key_type = Key;
+		using mapped_type = T;
+		using value_type = std::pair<Key, T>;
+		using allocator_type = Alloc;
+		using container_type = std::vector<value_type, Alloc>;
+		using iterator = typename container_type::iterator;
+		using const_iterator = typename container_type::const_iterator;
+		using size_type = size_t;
+
+		static constexpr size_t index_threshold = 8;
+	private:
+		struct Slot {
+			uint32_t hash;
+			uint32_t pos; //원소 위치 + 1, 0이면 빈 칸
+		};
+		using slot_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Slot>;
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
+		container_type items;
+		std::vector<Slot, slot_allocator> slots; //비어 있거나 크기가 2의 거듭제곱, 사용률은 1/2 이하
+
+		void Place(uint32_t hash, size_t pos) noexcept
+		{
+			const size_t mask = slots.size() - 1;
+			size_t i = hash & mask;
+			while (slots[i].pos != 0)
+				i = (i + 1) & mask;
+			slots[i] = Slot{ hash, static_cast<uint32_t>(pos + 1) };
+		}
+
+		void Rehash(size_t buckets)
+		{
+			slots.assign(buckets, Slot{ 0, 0 });
+			for (size_t i = 0; i < items.size(); i++)
+				Place(Hash(std::string_view(items[i].first)), i);
+		}
+
+		//원소 수가 바뀐 뒤 색인을 맞춤
+		void Reindex()
+		{
+			if (items.size() <= index_threshold) {
+				slots.clear();
+				return;
+			}
+			size_t buckets = 16;
+			while (buckets < items.size() * 2)
+				buckets <<= 1;
+			Rehash(buckets);
+		}
+
+		//같은 저장소를 가리키는 키(인터닝된 키 등)는 내용을 비교하지 않음
+		static bool SameKey(std::string_view a, std::string_view b) noexcept
+		{
+			return (a.data() == b.data() && a.size() == b.size()) || a == b;
+		}
+
+		size_t Lookup(std::string_view key, uint32_t hash) const noexcept
+		{
+			if (slots.empty()) {
+				for (size_t i = 0; i < items.size(); i++) {
+					if (SameKey(std::string_view(items[i].first), key))
+						return i;
+				}
+				return npos;
+			}
+
+			const size_t mask = slots.size() - 1;
+			for (size_t i = hash & mask;; i = (i + 1) & mask) {
+				const Slot& s = slots[i];
+				if (s.pos == 0)
+					return npos;
+				if (s.hash == hash && SameKey(std::string_view(items[s.pos - 1].first), key))
+					return s.pos - 1;
+			}
+		}
+
+		size_t Lookup(std::string_view key) const noexcept
+		{
+			return Lookup(key, slots.empty() ? 0 : Hash(key));
+		}
+	public:
+		//find(key, hash)에 넘길 해시. 같은 키를 반복해서 찾을 때 미리 계산해 둠
+		static uint32_t Hash(std::string_view key) noexcept
+		{
+			const size_t h = std::hash<std::string_view>()(key);
+			return static_cast<uint32_t>(h ^ (static_cast<uint64_t>(h) >> 32));
+		}
+
+		OrderedMap() = default;
+		explicit OrderedMap(const Alloc& alloc) : items(alloc), slots(slot_allocator(alloc)) {}
+
+		iterator begin() noexcept { return items.begin(); }
+		iterator end() noexcept { return items.end(); }
+		const_iterator begin() const noexcept { return items.begin(); }
+		const_iterator end() const noexcept { return items.end(); }
+		const_iterator cbegin() const noexcept { return items.cbegin(); }
+		const_iterator cend() const noexcept { return items.cend(); }
+
+		size_t size() const noexcept { return items.size(); }
+		bool empty() const noexcept { return items.empty(); }
+
+		void reserve(size_t n)
+		{
+			items.reserve(n);
+		}
+
+		void clear() noexcept
+		{
+			items.clear();
+			slots.clear();
+		}
+
+		iterator find(std::string_view key) noexcept
+		{
+			const size_t pos = Lookup(key);
+			return pos == npos ? end() : begin() + pos;
+		}
+
+		const_iterator find(std::string_view key) const noexcept
+		{
+			const size_t pos = Lookup(key);
+			return pos == npos ? end() : begin() + pos;
+		}
+
+		//hash는 Hash(key)의 결과
+		iterator find(std::string_view key, uint32_t hash) noexcept
+		{
+			const size_t pos = Lookup(key, hash);
+			return pos == npos ? end() : begin() + pos;
+		}
+
+		const_iterator find(std::string_view key, uint32_t hash) const noexcept
+		{
+			const size_t pos = Lookup(key, hash);
+			return pos == npos ? end() : begin() + pos;
+		}
+
+		size_t count(std::string_view key) const noexcept
+		{
+			return Lookup(key) != npos;
+		}
+
+		//키가 없으면 맨 뒤에 추가. 이미 있으면 값을 바꾸지 않고 false
+		//key는 std::string_view로 변환 가능하고 Key를 만들 수 있는 타입 (Key 자체를 넘기면 그대로 옮겨짐)
+		template <typename K>
+		std::pair<iterator, bool> try_emplace(K&& key, T value)
+		{
+			const std::string_view view(key);
+			const uint32_t hash = slots.empty() ? 0 : Hash(view); //색인이 없으면 해시가 필요 없음
+			const size_t pos = Lookup(view, hash);
+			if (pos != npos)
+				return { begin() + pos, false };
+
+			items.emplace_back(std::forward<K>(key), std::move(value));
+			if (!slots.empty() && items.size() * 2 <= slots.size())
+				Place(hash, items.size() - 1);
+			else if (items.size() > index_threshold)
+				Reindex();
+			return { end() - 1, true };
+		}
+
+		T& operator[](std::string_view key)
+		{
+			return try_emplace(key, T()).first->second;
+		}
+
+		//순서를 유지하므로 뒤의 원소를 당기고 색인을 다시 만듦
+		iterator erase(const_iterator it)
+		{
+			const size_t pos = it - cbegin();
+			items.erase(it);
+			Reindex();
+			return begin() + pos;
+		}
+
+		size_t erase(std::string_view key)
+		{
+			const auto it = find(key);
+			if (it == end())
+				return 0;
+			erase(it);
+			return 1;
+		}
+	};
+}
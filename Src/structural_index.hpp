@@ -0,0 +1,371 @@
+#pragma once
+#include <string.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define JSONLIB_X86_64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define JSONLIB_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define JSONLIB_TARGET_AVX2
+#endif
+
+namespace namespace_json_2 {
+	enum class SIMD_LEVEL {
+		SCALAR,
+		SSE2,
+		AVX2,
+	};
+
+	//64바이트 블록 하나의 문자 분류 결과. i번째 비트가 블록의 i번째 바이트
+	struct BlockMasks {
+		uint64_t quote;
+		uint64_t backslash;
+		uint64_t op; //{}[]:,
+		uint64_t space;
+	};
+
+	inline unsigned TrailingZeros(uint64_t v) noexcept
+	{
+#ifdef _MSC_VER
+		unsigned long idx;
+		_BitScanForward64(&idx, v);
+		return static_cast<unsigned>(idx);
+#else
+		return static_cast<unsigned>(__builtin_ctzll(v));
+#endif
+	}
+
+	namespace simd_detail {
+		inline bool IsSpace(unsigned char c) noexcept
+		{
+			return c == ' ' || (c >= '\t' && c <= '\r'); //std::isspace와 같은 집합
+		}
+
+		inline void ClassifyScalar(const char* p, BlockMasks& m) noexcept
+		{
+			m = BlockMasks{ 0, 0, 0, 0 };
+			for (int i = 0; i < 64; i++) {
+				const unsigned char c = static_cast<unsigned char>(p[i]);
+				const uint64_t bit = uint64_t(1) << i;
+				switch (c) {
+				case '"':
+					m.quote |= bit;
+					break;
+				case '\\':
+					m.backslash |= bit;
+					break;
+				case '{':
+				case '}':
+				case '[':
+				case ']':
+				case ':':
+				case ',':
+					m.op |= bit;
+					break;
+				default:
+					if (IsSpace(c))
+						m.space |= bit;
+				}
+			}
+		}
+
+#ifdef JSONLIB_X86_64
+		inline uint64_t Eq16x4(const __m128i v[4], char ch) noexcept
+		{
+			const __m128i c = _mm_set1_epi8(ch);
+			uint64_t r = 0;
+			for (int i = 0; i < 4; i++)
+				r |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[i], c)))) << (16 * i);
+			return r;
+		}
+
+		inline void ClassifySSE2(const char* p, BlockMasks& m) noexcept
+		{
+			__m128i v[4];
+			for (int i = 0; i < 4; i++)
+				v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+
+			m.quote = Eq16x4(v, '"');
+			m.backslash = Eq16x4(v, '\\');
+			m.op = Eq16x4(v, '{') | Eq16x4(v, '}') | Eq16x4(v, '[') | Eq16x4(v, ']') | Eq16x4(v, ':') | Eq16x4(v, ',');
+
+			//'\t'~'\r'은 c-9 <= 4 (부호 없는 비교)
+			const __m128i nine = _mm_set1_epi8(9), four = _mm_set1_epi8(4);
+			uint64_t ctl = 0;
+			for (int i = 0; i < 4; i++) {
+				const __m128i t = _mm_sub_epi8(v[i], nine);
+				const __m128i le = _mm_cmpeq_epi8(_mm_min_epu8(t, four), t);
+				ctl |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(le))) << (16 * i);
+			}
+			m.space = Eq16x4(v, ' ') | ctl;
+		}
+
+		JSONLIB_TARGET_AVX2 inline uint64_t Eq32x2(__m256i lo, __m256i hi, char ch) noexcept
+		{
+			const __m256i c = _mm256_set1_epi8(ch);
+			const uint64_t l = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c)));
+			const uint64_t h = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c)));
+			return l | (h << 32);
+		}
+
+		JSONLIB_TARGET_AVX2 inline void ClassifyAVX2(const char* p, BlockMasks& m) noexcept
+		{
+			const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+
+			m.quote = Eq32x2(lo, hi, '"');
+			m.backslash = Eq32x2(lo, hi, '\\');
+			m.op = Eq32x2(lo, hi, '{') | Eq32x2(lo, hi, '}') | Eq32x2(lo, hi, '[') | Eq32x2(lo, hi, ']')
+				| Eq32x2(lo, hi, ':') | Eq32x2(lo, hi, ',');
+
+			const __m256i nine = _mm256_set1_epi8(9), four = _mm256_set1_epi8(4);
+			const __m256i tl = _mm256_sub_epi8(lo, nine), th = _mm256_sub_epi8(hi, nine);
+			const uint64_t cl = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(tl, four), tl)));
+			const uint64_t ch = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(th, four), th)));
+			m.space = Eq32x2(lo, hi, ' ') | cl | (ch << 32);
+		}
+
+		inline bool CpuHasAVX2() noexcept
+		{
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+			__cpuid(info, 1);
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) //OS가 YMM 레지스터를 저장하는지
+				return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+#endif
+
+		//이스케이프된 따옴표를 제외하고, 문자열 내부 구간을 계산 (simdjson의 방식)
+		struct StringState {
+			uint64_t prev_escaped = 0;
+			uint64_t prev_in_string = 0;
+
+			uint64_t Escaped(uint64_t backslash) noexcept
+			{
+				if (backslash == 0) {
+					const uint64_t escaped = prev_escaped;
+					prev_escaped = 0;
+					return escaped;
+				}
+				backslash &= ~prev_escaped;
+				const uint64_t follows_escape = backslash << 1 | prev_escaped;
+				const uint64_t even_bits = 0x5555555555555555ULL;
+				const uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+				const uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+				prev_escaped = sequences_starting_on_even_bits < odd_sequence_starts; //carry
+				const uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+				return (even_bits ^ invert_mask) & follows_escape;
+			}
+
+			//따옴표 비트의 prefix xor -> 여는 따옴표부터 닫는 따옴표 직전까지 1
+			uint64_t InString(uint64_t quote) noexcept
+			{
+				uint64_t m = quote;
+				m ^= m << 1;
+				m ^= m << 2;
+				m ^= m << 4;
+				m ^= m << 8;
+				m ^= m << 16;
+				m ^= m << 32;
+				m ^= prev_in_string;
+				prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(m) >> 63);
+				return m;
+			}
+		};
+	}
+
+	//p부터 처음 나오는 '"', '{', '}', '[', ']'의 위치, 없으면 last
+	inline const char* FindQuoteOrBracket(const char* p, const char* last) noexcept
+	{
+#ifdef JSONLIB_X86_64
+		const __m128i q = _mm_set1_epi8('"'), lb = _mm_set1_epi8('{'), rb = _mm_set1_epi8('}');
+		const __m128i ls = _mm_set1_epi8('['), rs = _mm_set1_epi8(']');
+		while (last - p >= 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, lb)),
+				_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, rb), _mm_cmpeq_epi8(v, ls)), _mm_cmpeq_epi8(v, rs)));
+			const int mask = _mm_movemask_epi8(hit);
+			if (mask != 0)
+				return p + TrailingZeros(static_cast<uint64_t>(mask));
+			p += 16;
+		}
+#endif
+		for (; p != last; ++p) {
+			switch (*p) {
+			case '"':
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+				return p;
+			}
+		}
+		return last;
+	}
+
+	//p부터 처음으로 직렬화 시 이스케이프가 필요한 문자('"', '\\', '/', 0x20 미만)의 위치, 없으면 last
+	inline const char* FindEscape(const char* p, const char* last) noexcept
+	{
+#ifdef JSONLIB_X86_64
+		const __m128i q = _mm_set1_epi8('"'), bs = _mm_set1_epi8('\\'), sl = _mm_set1_epi8('/');
+		const __m128i ctrl = _mm_set1_epi8(0x1F);
+		while (last - p >= 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i low = _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl); //부호 없는 v <= 0x1F
+			const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, bs)),
+				_mm_or_si128(_mm_cmpeq_epi8(v, sl), low));
+			const int mask = _mm_movemask_epi8(hit);
+			if (mask != 0)
+				return p + TrailingZeros(static_cast<uint64_t>(mask));
+			p += 16;
+		}
+#endif
+		for (; p != last; ++p) {
+			const unsigned char c = static_cast<unsigned char>(*p);
+			if (c < 0x20 || c == '"' || c == '\\' || c == '/')
+				return p;
+		}
+		return last;
+	}
+
+	inline SIMD_LEVEL DetectSimdLevel() noexcept
+	{
+#ifdef JSONLIB_X86_64
+		static const SIMD_LEVEL level = simd_detail::CpuHasAVX2() ? SIMD_LEVEL::AVX2 : SIMD_LEVEL::SSE2;
+		return level;
+#else
+		return SIMD_LEVEL::SCALAR;
+#endif
+	}
+
+	//입력을 64바이트 블록 단위로 분류한 비트맵
+	//space: 공백, special: 문자열 안에서 멈춰야 할 '"'와 '\\', structural: 문자열 밖의 {}[]:,
+	//structural은 '"' 문자열만 인식하므로 엄격한 JSON 입력에서만 의미가 있음
+	class StructuralIndex {
+		std::vector<uint64_t> space, special, structural;
+		size_t length = 0;
+
+		static size_t NextSet(const std::vector<uint64_t>& bits, size_t pos, size_t limit) noexcept
+		{
+			if (pos >= limit)
+				return limit;
+			size_t word = pos >> 6;
+			uint64_t w = bits[word] & (~uint64_t(0) << (pos & 63));
+			const size_t words = bits.size();
+			while (w == 0) {
+				if (++word == words)
+					return limit;
+				w = bits[word];
+			}
+			const size_t found = (word << 6) + TrailingZeros(w);
+			return found < limit ? found : limit;
+		}
+
+		template <typename Classify>
+		void BuildWith(const char* data, size_t size, Classify classify)
+		{
+			simd_detail::StringState state;
+			const size_t full = size / 64;
+			BlockMasks m;
+			auto store = [&](size_t block, const BlockMasks& raw) {
+				const uint64_t quote = raw.quote & ~state.Escaped(raw.backslash);
+				const uint64_t in_string = state.InString(quote);
+				space[block] = raw.space;
+				special[block] = raw.quote | raw.backslash;
+				structural[block] = raw.op & ~in_string;
+			};
+
+			for (size_t b = 0; b < full; b++) {
+				classify(data + b * 64, m);
+				store(b, m);
+			}
+
+			if (full * 64 != size) { //마지막 불완전 블록은 공백으로 채운 복사본에서 분류
+				char tail[64];
+				memset(tail, ' ', sizeof(tail));
+				memcpy(tail, data + full * 64, size - full * 64);
+				classify(tail, m);
+				store(full, m);
+			}
+		}
+
+	public:
+		StructuralIndex() = default;
+		StructuralIndex(const char* data, size_t size, SIMD_LEVEL level = DetectSimdLevel())
+		{
+			Build(data, size, level);
+		}
+
+		void Build(const char* data, size_t size, SIMD_LEVEL level = DetectSimdLevel())
+		{
+			const size_t blocks = (size + 63) / 64;
+			length = size;
+			space.resize(blocks);
+			special.resize(blocks);
+			structural.resize(blocks);
+
+			switch (level) {
+#ifdef JSONLIB_X86_64
+			case SIMD_LEVEL::AVX2:
+				BuildWith(data, size, simd_detail::ClassifyAVX2);
+				break;
+			case SIMD_LEVEL::SSE2:
+				BuildWith(data, size, simd_detail::ClassifySSE2);
+				break;
+#endif
+			default:
+				BuildWith(data, size, simd_detail::ClassifyScalar);
+			}
+		}
+
+		size_t size() const noexcept { return length; }
+
+		//pos 이후 처음으로 공백이 아닌 위치, 없으면 size()
+		size_t NextNonSpace(size_t pos) const noexcept
+		{
+			if (pos >= length)
+				return length;
+			size_t word = pos >> 6;
+			uint64_t w = ~space[word] & (~uint64_t(0) << (pos & 63));
+			const size_t words = space.size();
+			while (w == 0) {
+				if (++word == words)
+					return length;
+				w = ~space[word];
+			}
+			const size_t found = (word << 6) + TrailingZeros(w);
+			return found < length ? found : length;
+		}
+
+		//pos 이후 처음 나오는 '"' 또는 '\\'의 위치, 없으면 size()
+		size_t NextSpecial(size_t pos) const noexcept
+		{
+			return NextSet(special, pos, length);
+		}
+
+		//pos 이후 문자열 밖의 첫 구조 문자 위치, 없으면 size()
+		size_t NextStructural(size_t pos) const noexcept
+		{
+			return NextSet(structural, pos, length);
+		}
+	};
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+namespace http_request {
+	class ThreadPool {
+		std::vector<std::thread> threads;
+		std::queue<std::function<void()>> tasks;
+		std::mutex lock;
+		std::condition_variable cv;
+		bool stop;
+
+		void Work()
+		{
+			while (true)
+			{
+				std::unique_lock<std::mutex> lk(lock);
+				cv.wait(lk, [this]() {return this->stop || !this->tasks.empty(); });
+				if (stop)
+					return;
+				std::function<void()> task = move(tasks.front());
+				tasks.pop();
+				lk.unlock();
+				
+				task();
+			}
+		}
+	public:
+		ThreadPool() = delete;
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) = delete;
+		ThreadPool(size_t count) : stop(false)
+		{
+			if (count == 0)
+				throw std::invalid_argument("스레드 수는 0보다 커야합니다");
+			for (size_t i = 0; i < count; i++)
+			{
+				threads.push_back(std::thread([this]() { this->Work(); }));
+			}
+		}
+
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lk(lock); //대기 중인 스레드가 깨어남을 놓치지 않도록
+				stop = true;
+			}
+			cv.notify_all();
+		}
+
+		~ThreadPool()
+		{
+			Stop();
+
+			for (size_t i = 0U; i < threads.size(); i++)
+			{
+				if (threads[i].joinable())
+					threads[i].join();
+			}
+		}
+
+		size_t size() const noexcept
+		{
+			return threads.size();
+		}
+		
+		template <typename Fn, typename... Args>
+		auto EnqueueTask(Fn&& fn, Args&&... args)
+		{
+			using namespace std;
+			using rType = typename result_of<Fn(Args...)>::type;
+			auto task = make_shared<packaged_task<rType()>>(
+				std::bind(forward<Fn>(fn), forward<Args>(args)...)
+				);
+			auto future = task->get_future();
+			{
+				lock_guard<mutex> lk(lock);
+				tasks.push([task]() { (*task)(); });
+			}
+			cv.notify_one();
+			return future;
+		}
+	};
+}